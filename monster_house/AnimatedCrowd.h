@@ -0,0 +1,137 @@
+#ifndef ANIMATED_CROWD_H
+#define ANIMATED_CROWD_H
+
+#include <deque>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <animatedmodel.h>
+#include <animationprofile.h>
+#include <animator.h>
+#include <shader_m.h>
+#include "RenderableObject.h"
+
+/**
+ * @brief Multitud de instancias de un mismo AnimatedModel.
+ *
+ * Cada instancia tiene su posicion, su giro y su propio Animator, pero todas comparten
+ * el modelo cargado y su skeleton compilado. Las poses de todas se calculan con un
+ * solo Animator::updateBatch, de a cuatro instancias por registro SIMD, en vez de un
+ * update por personaje.
+ */
+class AnimatedCrowd : public RenderableObject {
+private:
+    struct Instance {
+        glm::vec3 offset;       // relativo a la posicion de la multitud
+        float rotationY;        // grados
+        Animator animator;
+    };
+
+    AnimatedModel* animatedModel;
+    // en deque para que los punteros de animators sigan validos al agregar instancias
+    std::deque<Instance> instances;
+    std::vector<Animator*> animators;
+    // union de las instancias y las bounds del modelo con que se armo; el modelo las
+    // agranda mientras suben sus meshes, y entonces se rearma en el siguiente pedido
+    mutable Bounds localBounds = Bounds::empty();
+    mutable Bounds localBoundsSource = Bounds::empty();
+
+    static glm::mat4 getInstanceMatrix(const glm::mat4& crowdMatrix, const Instance& instance) {
+        glm::mat4 modelMatrix = glm::translate(crowdMatrix, instance.offset);
+        return glm::rotate(modelMatrix, glm::radians(instance.rotationY), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    bool localBoundsStale() const {
+        const Bounds& source = animatedModel->bounds;
+        return source.min != localBoundsSource.min || source.max != localBoundsSource.max;
+    }
+
+    void rebuildLocalBounds() const {
+        localBoundsSource = animatedModel->bounds;
+        localBounds = Bounds::empty();
+        if (localBoundsSource.isEmpty()) return;
+        for (const Instance& instance : instances)
+            localBounds.merge(localBoundsSource.transformed(getInstanceMatrix(glm::mat4(1.0f), instance)));
+    }
+
+public:
+    AnimatedCrowd(AnimatedModel* mdl, Shader* shdr, glm::vec3 pos = glm::vec3(0.0f),
+        glm::vec3 scl = glm::vec3(1.0f))
+        : RenderableObject(nullptr, shdr, pos, glm::vec3(0.0f), scl),
+          animatedModel(mdl) {
+    }
+
+    /**
+     * @brief Agrega un personaje; startTime (ticks, se envuelve a la duracion del
+     * clip) desfasa su reproduccion para que la multitud no se mueva al unisono.
+     */
+    void addInstance(glm::vec3 offset, float rotationY = 0.0f, float startTime = 0.0f) {
+        instances.push_back(Instance{ offset, rotationY, Animator(animatedModel, animatedModel->defaultAnimation) });
+        instances.back().animator.setTime(startTime);
+        animators.push_back(&instances.back().animator);
+
+        if (localBoundsStale())
+            rebuildLocalBounds();
+        else if (!localBoundsSource.isEmpty())
+            localBounds.merge(localBoundsSource.transformed(getInstanceMatrix(glm::mat4(1.0f), instances.back())));
+    }
+
+    size_t getInstanceCount() const { return instances.size(); }
+
+    void update(float deltaTime) override {
+        RenderableObject::update(deltaTime);
+        if (animators.empty() || !animators[0]->isPlayable()) return;
+
+        AnimationTimer timer("crowd poses");
+        Animator::updateBatch(animators.data(), animators.size(), deltaTime);
+    }
+
+    void render(const glm::mat4& projection, const glm::mat4& view,
+        const LightManager& lightManager, const glm::vec3& eyePosition) override {
+        if (!animatedModel || !shader || instances.empty()) return;
+
+        // prioridad de streaming de sus texturas
+        const Bounds& bounds = getWorldBounds();
+        if (!bounds.isEmpty())
+            animatedModel->viewDistance = std::min(animatedModel->viewDistance,
+                std::max(glm::length(bounds.center - eyePosition) - bounds.radius, 0.0f));
+
+        shader->use();
+        shader->setMat4("projection", projection);
+        shader->setMat4("view", view);
+
+        // sin fisicas: ninguna instancia salta
+        shader->setFloat("physicsTime", 0.0f);
+        shader->setBool("isJumping", false);
+        shader->setFloat("initialVelocity", 0.0f);
+        shader->setFloat("lunarGravity", 1.62f);
+        shader->setFloat("astronautMass", 180.0f);
+        shader->setFloat("groundLevel", 0.0f);
+
+        lightManager.applyLights(shader, affectedLights);
+
+        shader->setVec3("eye", eyePosition);
+        shader->setVec4("MaterialAmbientColor", material.ambient);
+        shader->setVec4("MaterialDiffuseColor", material.diffuse);
+        shader->setVec4("MaterialSpecularColor", material.specular);
+        shader->setFloat("transparency", material.transparency);
+
+        glm::mat4 crowdMatrix = getModelMatrix();
+        for (const Instance& instance : instances) {
+            shader->setMat4("model", getInstanceMatrix(crowdMatrix, instance));
+            shader->setMat4("gBones", MAX_RIGGING_BONES, instance.animator.getBones());
+            animatedModel->Draw(*shader);
+        }
+        glUseProgram(0);
+    }
+
+    // union de la pose de reposo de cada instancia en el espacio de la multitud
+    Bounds getLocalBounds() const override {
+        if (!animatedModel) return Bounds::empty();
+        if (localBoundsStale()) rebuildLocalBounds();
+        return localBounds;
+    }
+};
+
+#endif // ANIMATED_CROWD_H
@@ -3,6 +3,7 @@
 
 #include <glm/glm.hpp>
 #include <animatedmodel.h>
+#include <animator.h>
 #include <shader_m.h>
 #include "RenderableObject.h"
 #include "PhysicsSystem.h"
@@ -18,6 +19,9 @@ private:
     bool isMoving;
     glm::vec3 lastPosition;
     PhysicsSystem* physicsSystem;
+    Animator animator; // estado propio; el modelo se comparte con otros objetos
+    const float* externalSpeed; // parametro de velocidad del grafo (jugador)
+    int speedParameter;
 
 public:
     AnimatedRenderableObject(AnimatedModel* mdl, Shader* shdr, PhysicsSystem* physics,
@@ -26,7 +30,9 @@ public:
         : RenderableObject(nullptr, shdr, glm::vec3(0.0f), glm::vec3(0.0f), scl),
           animatedModel(mdl), physicsSystem(physics),
           externalPosition(extPos), externalRotation(extRot),
-          isMoving(false), lastPosition(0.0f) {
+          isMoving(false), lastPosition(0.0f),
+          animator(mdl, mdl ? mdl->defaultAnimation : 0),
+          externalSpeed(nullptr), speedParameter(-1) {
         if (externalPosition) {
             lastPosition = *externalPosition;
         }
@@ -50,9 +56,15 @@ public:
             rotation.y = *externalRotation;
         }
 
-        // Actualizar la animacin solo si el modelo se est moviendo
-        if (animatedModel && isMoving) {
-            animatedModel->UpdateAnimation(deltaTime);
+        // Con grafo la animacion corre siempre (el estado de reposo es parte del grafo);
+        // sin grafo, solo si el modelo se esta moviendo
+        if (animatedModel && animator.getGraph()) {
+            if (externalSpeed)
+                animator.setParameter(speedParameter, *externalSpeed);
+            animator.update(deltaTime);
+        }
+        else if (animatedModel && isMoving) {
+            animator.update(deltaTime);
         }
 
         // Actualizar el sistema de fsicas (salto)
@@ -65,13 +77,19 @@ public:
         const LightManager& lightManager, const glm::vec3& eyePosition) override {
         if (!animatedModel || !shader) return;
 
+        // prioridad de streaming de sus texturas
+        const Bounds& bounds = getWorldBounds();
+        if (!bounds.isEmpty())
+            animatedModel->viewDistance = std::min(animatedModel->viewDistance,
+                std::max(glm::length(bounds.center - eyePosition) - bounds.radius, 0.0f));
+
         shader->use();
         shader->setMat4("projection", projection);
         shader->setMat4("view", view);
         shader->setMat4("model", getModelMatrix());
 
         // Enviar datos de los huesos (skinning)
-        shader->setMat4("gBones", MAX_RIGGING_BONES, animatedModel->gBones);
+        shader->setMat4("gBones", MAX_RIGGING_BONES, animator.getBones());
 
         // Enviar datos de fsicas
         if (physicsSystem) {
@@ -104,7 +122,24 @@ public:
         glUseProgram(0);
     }
 
+    // pose de reposo: la animacion puede salirse un poco de este volumen
+    Bounds getLocalBounds() const override {
+        return animatedModel ? animatedModel->bounds : Bounds::empty();
+    }
+
     bool getIsMoving() const { return isMoving; }
+    Animator& getAnimator() { return animator; }
+
+    /**
+     * @brief Reproduce un grafo de animacion; speed (si no es nulo) se copia cada frame
+     * al parametro speedParameterName del grafo.
+     */
+    void setAnimationGraph(const AnimationGraph* graph, const float* speed = nullptr,
+        const std::string& speedParameterName = "speed") {
+        animator.setGraph(graph);
+        externalSpeed = speed;
+        speedParameter = graph ? graph->findParameter(speedParameterName) : -1;
+    }
 };
 
 #endif // ANIMATED_RENDERABLE_OBJECT_H
@@ -0,0 +1,225 @@
+#ifndef ASSET_HOT_RELOAD_H
+#define ASSET_HOT_RELOAD_H
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <assetcooker.h>
+#include <filewatcher.h>
+#include <shader_m.h>
+#include <textureregistry.h>
+#include <threadpool.h>
+#include <uploadqueue.h>
+
+#include "AssetLoader.h"
+
+/**
+ * @brief Recarga en caliente de modelos, texturas y shaders.
+ *
+ * Un FileWatcher vigila el directorio de assets. Cuando un archivo termina de
+ * cambiar, solo ese asset se vuelve a cocinar en un hilo de trabajo (el cache
+ * .mhc / .cooked.dds queda invalidado por el hash de la fuente) y el resultado se
+ * cambia en el hilo GL desde una UploadQueue, con un presupuesto por frame:
+ *  - Model / AnimatedModel: se arma un modelo nuevo y se mueve sobre el objeto
+ *    existente, asi los RenderableObject que lo apuntan ven el cambio sin tocarlos.
+ *  - Texturas: TextureRegistry::replace cambia el id detras del handle compartido.
+ *  - Shaders: se recompilan en el hilo GL y solo se cambia el programa si enlaza.
+ * Si algo falla se conserva la version anterior.
+ */
+class AssetHotReload {
+private:
+    // Tiempo maximo por frame para aplicar recargas terminadas
+    const double UPLOAD_BUDGET_SECONDS = 0.002;
+
+    struct WatchedModel {
+        Model* model;
+        AnimatedModel* animatedModel;
+        std::string path;
+        ImportOptions options;
+    };
+
+    FileWatcher watcher;
+    std::vector<WatchedModel> models;
+    std::vector<Shader*> shaders;
+    // trabajos en curso por asset; si vuelve a cambiar mientras tanto se repite al terminar
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> inFlight;
+    std::unordered_set<std::string> changedAgain;
+    std::vector<std::string> changed;
+    std::atomic<int> pendingJobs;
+
+    // El pool se declara al final para destruirse primero: sus hilos usan la cola
+    UploadQueue uploads;
+    ThreadPool pool;
+
+    static std::string canonical(const std::string& path) {
+        return TextureRegistry::canonicalPath(path);
+    }
+
+    static void keepState(Model*, Model*) {}
+    static void keepState(AnimatedModel* target, AnimatedModel* fresh) {
+        fresh->defaultAnimation = target->defaultAnimation;
+    }
+
+    bool beginJob(const std::string& key) {
+        if (inFlight.count(key)) {
+            changedAgain.insert(key);
+            return false;
+        }
+        inFlight[key] = std::chrono::steady_clock::now();
+        pendingJobs++;
+        return true;
+    }
+
+    // En el hilo GL, al aplicar (o descartar) una recarga
+    void endJob(const std::string& key, const std::string& path, bool applied) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - inFlight[key];
+        inFlight.erase(key);
+        pendingJobs--;
+        std::cout << (applied ? "Hot reload: " : "Hot reload failed, keeping previous version: ")
+            << path << " | " << elapsed.count() << " ms" << std::endl;
+        if (changedAgain.erase(key))
+            onFileChanged(path);
+    }
+
+    template <typename T>
+    void reloadModel(T* target, const std::string& path, const ImportOptions& options) {
+        if (!beginJob(path)) return;
+        T* fresh = new T();
+        keepState(target, fresh);
+        pool.submit([this, target, fresh, path, options] {
+            // el hash de la fuente cambio: esto vuelve a importar y reescribe el cache
+            std::shared_ptr<ModelData> data = std::make_shared<ModelData>();
+            if (!loadModelRuntimeData(path, *data, options)) {
+                uploads.push([this, fresh, path] {
+                    delete fresh;
+                    endJob(path, path, false);
+                });
+                return;
+            }
+
+            AssetLoader::queueModelUploads(uploads, fresh, data);
+            uploads.push([this, target, fresh, path] {
+                fresh->finishLoading();
+                for (Mesh& mesh : target->meshes)
+                    mesh.release();
+                *target = std::move(*fresh);
+                delete fresh;
+                endJob(path, path, true);
+            });
+        });
+    }
+
+    void reloadTexture(const std::string& path) {
+        const TextureRole roles[] = { TEXTURE_ROLE_COLOR, TEXTURE_ROLE_NORMAL, TEXTURE_ROLE_DATA };
+        for (TextureRole role : roles) {
+            // solo las versiones que algun modelo tiene cargadas
+            std::string key = textureRoleKey(canonical(path), role);
+            if (!TextureRegistry::instance().isLoaded(key) || !beginJob(key)) continue;
+
+            pool.submit([this, path, role, key] {
+                TextureKey textureKey = TextureRegistry::makeKey(path, role);
+                uint64_t sourceHash = TextureRegistry::sourceHash(path, role);
+                std::shared_ptr<CompressedImage> image = std::make_shared<CompressedImage>();
+                bool cooked = loadCookedTexture(path, role, sourceHash, *image);
+                uploads.push([this, path, key, textureKey, sourceHash, image, cooked] {
+                    bool applied = cooked && TextureRegistry::instance().replace(textureKey, sourceHash, uploadCompressedTexture(*image));
+                    endJob(key, path, applied);
+                });
+            });
+        }
+    }
+
+    void reloadShader(Shader* shader) {
+        auto start = std::chrono::steady_clock::now();
+        Shader fresh(shader->vertexFile.c_str(), shader->fragmentFile.c_str(),
+            shader->geometryFile.empty() ? nullptr : shader->geometryFile.c_str());
+        bool applied = fresh.isLinked();
+        if (applied) {
+            forgetMeshUniformLocations(shader->ID);
+            glDeleteProgram(shader->ID);
+            shader->ID = fresh.ID;
+            if (shader->boneCount > 0)
+                shader->setBonesIDs(shader->boneCount);
+        }
+        else {
+            glDeleteProgram(fresh.ID);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << (applied ? "Hot reload: " : "Hot reload failed, keeping previous version: ")
+            << shader->vertexFile << " + " << shader->fragmentFile << " | " << elapsed.count() << " ms" << std::endl;
+    }
+
+    void onFileChanged(const std::string& path) {
+        std::string file = canonical(path);
+
+        for (Shader* shader : shaders) {
+            if (file == canonical(shader->vertexFile) || file == canonical(shader->fragmentFile) ||
+                (!shader->geometryFile.empty() && file == canonical(shader->geometryFile)))
+                reloadShader(shader);
+        }
+
+        if (isModelSource(path)) {
+            for (const WatchedModel& watched : models) {
+                if (file != canonical(watched.path)) continue;
+                if (watched.model) reloadModel(watched.model, watched.path, watched.options);
+                else reloadModel(watched.animatedModel, watched.path, watched.options);
+            }
+        }
+        else if (isTextureSource(path)) {
+            reloadTexture(path);
+        }
+    }
+
+public:
+    AssetHotReload(const std::string& assetDirectory, unsigned int numThreads = 1)
+        : pendingJobs(0), uploads(64), pool(numThreads) {
+        if (watcher.start(assetDirectory))
+            std::cout << "Hot reload: watching " << assetDirectory << std::endl;
+        else
+            std::cout << "WARNING::HOT_RELOAD:: could not watch " << assetDirectory << std::endl;
+    }
+
+    /**
+     * @brief Los hilos de trabajo pueden estar esperando espacio en la cola, asi
+     * que se aplican las recargas pendientes antes de destruir el pool.
+     */
+    ~AssetHotReload() {
+        while (pendingJobs > 0)
+            uploads.drain(UPLOAD_BUDGET_SECONDS);
+    }
+
+    AssetHotReload(const AssetHotReload&) = delete;
+    AssetHotReload& operator=(const AssetHotReload&) = delete;
+
+    /**
+     * @brief Vigila todos los modelos que pidio un AssetLoader, con sus opciones.
+     */
+    void watchModels(const AssetLoader& loader) {
+        for (const AssetLoader::LoadedModel& loaded : loader.getLoadedModels())
+            models.push_back(WatchedModel{ loaded.model, loaded.animatedModel, loaded.path, loaded.options });
+    }
+
+    void watchShader(Shader* shader) {
+        if (shader) shaders.push_back(shader);
+    }
+
+    /**
+     * @brief Una vez por frame en el hilo GL: revisa cambios sin bloquear, lanza los
+     * recocinados y aplica los que ya terminaron.
+     */
+    void update() {
+        watcher.poll(changed);
+        for (const std::string& path : changed)
+            onFileChanged(path);
+        if (!uploads.empty())
+            uploads.drain(UPLOAD_BUDGET_SECONDS);
+    }
+};
+
+#endif // ASSET_HOT_RELOAD_H
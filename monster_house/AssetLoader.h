@@ -0,0 +1,289 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <task.h>
+#include <threadpool.h>
+#include <uploadqueue.h>
+#include <model.h>
+#include <animatedmodel.h>
+#include <cubemap.h>
+
+#include "AssetStreamer.h"
+#include "LoadingScreen.h"
+
+/**
+ * @brief Carga de recursos en segundo plano.
+ *
+ * El parseo con Assimp (o la lectura del cache cocinado) y la decodificacion de
+ * imagenes corren en un pool de hilos. Todo lo que crea objetos de OpenGL se
+ * encola en una UploadQueue que el hilo principal vacia entre frames, de modo
+ * que la pantalla de carga sigue dibujandose y el arranque en frio queda
+ * limitado por el recurso mas lento y no por la suma de todos.
+ *
+ * Cada carga es una Task (corrutina de C++20): se inicia desde el hilo GL, sigue en
+ * un hilo de trabajo para la E/S y la decodificacion, y termina de nuevo en el hilo GL
+ * con el recurso ya subido. Asi el codigo de la escena hace co_await loadModel(...)
+ * y sigue en el hilo GL, y con whenAll() lanza cargas independientes a la vez:
+ *
+ *     auto [piso, casa] = co_await whenAll(loader.loadModel("piso.fbx"), loader.loadModel("casa.fbx"));
+ *
+ * Con un AssetStreamer, las cargas terminan con los LODs mas simples y los mips
+ * chicos; el detalle completo sigue llegando mientras la escena ya corre.
+ */
+class AssetLoader {
+public:
+    /**
+     * @brief Modelo pedido al loader: lo que necesita la recarga en caliente para
+     * volver a cocinarlo con las mismas opciones.
+     */
+    struct LoadedModel {
+        Model* model;
+        AnimatedModel* animatedModel;
+        std::string path;
+        ImportOptions options;
+    };
+
+private:
+    // Tiempo maximo de subidas a la GPU por frame de la pantalla de carga
+    const double UPLOAD_BUDGET_SECONDS = 0.008;
+
+    // El pool se declara al final para destruirse primero: sus hilos usan la cola y los contadores
+    std::atomic<int> totalJobs;
+    std::atomic<int> completedJobs;
+    UploadQueue uploads;
+    std::vector<LoadedModel> loadedModels;
+    AssetStreamer* streamer;
+    std::chrono::steady_clock::time_point created;
+    ThreadPool pool;
+
+    template <typename T>
+    Task<> loadModelInto(T* model, std::string path, ImportOptions options) {
+        co_await resumeOn(pool);
+        // la escena de Assimp se libera aqui mismo; a la cola solo pasan los datos propios
+        std::shared_ptr<ModelData> data = std::make_shared<ModelData>();
+        bool loaded = loadModelRuntimeData(path, *data, options);
+        if (loaded)
+            queueModelUploads(uploads, model, data, streamer);
+        else
+            cout << "ERROR::ASSET_LOADER:: could not load " << path << endl;
+
+        // la cola es FIFO: al reanudar en el hilo GL las subidas del modelo ya corrieron
+        co_await resumeOn(uploads);
+        if (loaded) model->finishLoading();
+        completedJobs++;
+    }
+
+    // Solo los Model tienen proxies de carga progresiva (los meshes con huesos no tienen
+    // LODs); un AnimatedModel siempre sube sus meshes completos
+    static bool queueMeshProxy(UploadQueue& uploads, Model* model, const std::shared_ptr<ModelData>& data,
+        size_t index, AssetStreamer* streamer) {
+        std::shared_ptr<MeshProxy> proxy = std::make_shared<MeshProxy>();
+        if (!buildMeshProxy(data->meshes[index], *proxy)) return false;
+        uploads.push([model, data, index, proxy, streamer] {
+            model->addMesh(data->meshes[index], proxy.get());
+            streamer->requestMesh(model, model->meshes.size() - 1, data);
+        });
+        return true;
+    }
+
+    static bool queueMeshProxy(UploadQueue&, AnimatedModel*, const std::shared_ptr<ModelData>&, size_t, AssetStreamer*) {
+        return false;
+    }
+
+    Task<bool> compressCubemapFace(std::string face, CompressedImage& image) {
+        co_await resumeOn(pool);
+        int components;
+        bool loaded = compressTextureFile(face, TEXTURE_ROLE_COLOR, image, components);
+        if (!loaded)
+            std::cout << "Cubemap tex failed to load at path: " << face << std::endl;
+        co_return loaded;
+    }
+
+public:
+    /**
+     * @brief Encola (desde un hilo de trabajo) la creacion en GPU de un modelo ya
+     * importado: texturas, informacion del modelo y meshes. No llama a finishLoading(),
+     * que queda a cargo de quien encola, junto con lo que tenga que hacer al terminar.
+     * Con streamer solo se suben los LODs mas simples y los mips chicos, y el resto
+     * queda pedido al AssetStreamer.
+     */
+    template <typename T>
+    static void queueModelUploads(UploadQueue& uploads, T* model, const std::shared_ptr<ModelData>& data,
+        AssetStreamer* streamer = nullptr) {
+        // Cargar (o cocinar) cada textura distinta una sola vez, fuera del hilo GL. Las
+        // que ya estan en el TextureRegistry (de otro modelo) no se vuelven a leer.
+        TextureRegistry& registry = TextureRegistry::instance();
+        std::vector<std::string> resolved;
+        for (const MeshData& mesh : data->meshes) {
+            for (const TextureRef& ref : mesh.textures) {
+                if (ref.solidColor) continue;
+                TextureRole role = textureRoleForType(ref.type);
+                std::string roleKey = textureRoleKey(ref.path, role);
+                if (std::find(resolved.begin(), resolved.end(), roleKey) != resolved.end()) continue;
+                resolved.push_back(roleKey);
+
+                std::string filename = data->directory + '/' + ref.path;
+                TextureKey key = TextureRegistry::makeKey(filename, role);
+                TextureHandle existing = registry.acquire(key);
+                if (existing) {
+                    uploads.push([model, roleKey, existing] { model->addTexture(roleKey, existing); });
+                    continue;
+                }
+                if (!registry.beginLoad(key)) {
+                    // otro hilo la cargo mientras tanto y su subida ya esta antes en la cola
+                    uploads.push([model, roleKey, key, filename, role] {
+                        TextureHandle handle = TextureRegistry::instance().acquire(key);
+                        model->addTexture(roleKey, handle ? handle : TextureRegistry::instance().load(filename, role));
+                    });
+                    continue;
+                }
+
+                // solo aqui, con la ruta sin cargar, se lee la fuente para el hash
+                uint64_t sourceHash = TextureRegistry::sourceHash(filename, role);
+                existing = registry.acquireContent(key, sourceHash);
+                if (existing) {
+                    uploads.push([model, roleKey, existing] { model->addTexture(roleKey, existing); });
+                    registry.endLoad(key);
+                    continue;
+                }
+
+                std::shared_ptr<CompressedImage> image = std::make_shared<CompressedImage>();
+                if (!loadCookedTexture(filename, role, sourceHash, *image))
+                    std::cout << "Texture failed to load at path: " << filename << std::endl;
+
+                uploads.push([model, image, roleKey, key, sourceHash, streamer] {
+                    size_t firstLevel = streamer ? streamingBaseLevel(*image, STREAMING_BASE_TEXTURE_SIZE) : 0;
+                    unsigned int id = uploadCompressedTexture(*image, false, firstLevel);
+                    TextureHandle handle = TextureRegistry::instance().insert(key, sourceHash, id);
+                    model->addTexture(roleKey, handle);
+                    // si otro modelo la registro antes, esta copia se descarto y no hay nada que refinar
+                    if (firstLevel > 0 && handle->id == id)
+                        streamer->requestTexture(&model->viewDistance, handle, image, firstLevel);
+                });
+                registry.endLoad(key);
+            }
+        }
+
+        // La cola es FIFO: la informacion del modelo llega antes que sus meshes
+        uploads.push([model, data] { model->setupModelInfo(*data); });
+        for (size_t i = 0; i < data->meshes.size(); i++) {
+            if (streamer && queueMeshProxy(uploads, model, data, i, streamer)) continue;
+            uploads.push([model, data, i] { model->addMesh(data->meshes[i]); });
+        }
+    }
+
+    AssetLoader(unsigned int numThreads = 0, AssetStreamer* streamer = nullptr)
+        : totalJobs(0), completedJobs(0), uploads(64), streamer(streamer),
+          created(std::chrono::steady_clock::now()), pool(numThreads) {
+    }
+
+    /**
+     * @brief Los hilos de trabajo pueden estar bloqueados esperando espacio en
+     * la cola, asi que se termina de vaciar antes de destruir el pool.
+     */
+    ~AssetLoader() {
+        while (!isFinished())
+            uploads.drain(UPLOAD_BUDGET_SECONDS);
+    }
+
+    /**
+     * @brief Carga un modelo; la tarea termina en el hilo GL con el modelo listo
+     * (o vacio, si no se pudo cargar). Se inicia desde el hilo GL.
+     */
+    Task<Model*> loadModel(std::string path, ImportOptions options = ImportOptions()) {
+        Model* model = new Model();
+        loadedModels.push_back(LoadedModel{ model, nullptr, path, options });
+        totalJobs++;
+        co_await loadModelInto(model, path, options);
+        co_return model;
+    }
+
+    Task<AnimatedModel*> loadAnimatedModel(std::string path, unsigned int cAnimation = 0) {
+        AnimatedModel* model = new AnimatedModel();
+        model->defaultAnimation = cAnimation;
+        loadedModels.push_back(LoadedModel{ nullptr, model, path, ImportOptions() });
+        totalJobs++;
+        co_await loadModelInto(model, path, ImportOptions());
+        co_return model;
+    }
+
+    /**
+     * @brief Lee el cubemap cocinado (un solo archivo con las seis caras) en un hilo
+     * de trabajo y crea la textura cubica en el hilo GL. Si no esta cocinado, cada cara
+     * se decodifica y comprime en su propio hilo y se escribe el cubemap cocinado para
+     * el siguiente arranque.
+     */
+    Task<CubeMap*> loadCubemap(std::vector<std::string> faces) {
+        CubeMap* cubemap = new CubeMap();
+        totalJobs++;
+        co_await resumeOn(pool);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<CompressedImage> images(faces.size());
+        std::string cookedPath = cookedCubemapPath(faces);
+        uint64_t sourceHash = cubemapSourceHash(faces, cookedPath);
+        if (sourceHash == 0 || !readCookedCubemap(cookedPath, sourceHash, images)) {
+#if COOKED_ASSETS_ONLY
+            std::cout << "ERROR::TEXTURE_COOKER:: missing or stale cooked cubemap " << cookedPath << std::endl;
+#else
+            std::vector<Task<bool>> faceJobs;
+            for (size_t i = 0; i < faces.size(); i++)
+                faceJobs.push_back(compressCubemapFace(faces[i], images[i]));
+            std::vector<bool> loaded = co_await whenAll(std::move(faceJobs));
+
+            // se sigue en el hilo de la ultima cara en terminar
+            bool allLoaded = std::find(loaded.begin(), loaded.end(), false) == loaded.end();
+            if (allLoaded && sourceHash != 0 && !writeCookedCubemap(cookedPath, sourceHash, images))
+                std::cout << "WARNING::TEXTURE_COOKER:: could not write " << cookedPath << std::endl;
+#endif
+        }
+
+        co_await resumeOn(uploads);
+        cubemap->uploadCubemap(images);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Cubemap loaded: " << cookedPath << " | " << elapsed.count() << " ms" << std::endl;
+        completedJobs++;
+        co_return cubemap;
+    }
+
+    bool isFinished() const { return completedJobs == totalJobs; }
+    const std::vector<LoadedModel>& getLoadedModels() const { return loadedModels; }
+    int getCompleted() const { return completedJobs; }
+    int getTotal() const { return totalJobs; }
+
+    /**
+     * @brief Ejecuta en el hilo GL las subidas pendientes de este frame.
+     */
+    void update() {
+        uploads.drain(UPLOAD_BUDGET_SECONDS);
+    }
+
+    /**
+     * @brief Bucle de la pantalla de carga: vacia la cola con un presupuesto por
+     * frame y redibuja hasta que la tarea (ya arrancada con start()) y todos los
+     * recursos pedidos terminen.
+     */
+    template <typename T>
+    void finish(LoadingScreen& loadingScreen, const Task<T>& task) {
+        while (!task.isReady() || !isFinished()) {
+            update();
+            loadingScreen.setSubProgress(getCompleted(), getTotal());
+            loadingScreen.render();
+        }
+        loadingScreen.setSubProgress(0, 0);
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - created;
+        std::cout << "Assets ready for the first frame in " << elapsed.count() << " ms";
+        if (streamer)
+            std::cout << " (" << streamer->getPendingCount() << " refinements left to stream)";
+        std::cout << std::endl;
+    }
+};
+
+#endif // ASSET_LOADER_H
@@ -0,0 +1,207 @@
+#ifndef ASSET_STREAMER_H
+#define ASSET_STREAMER_H
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <mappedfile.h>
+#include <model.h>
+#include <texturecooker.h>
+#include <textureregistry.h>
+#include <threadpool.h>
+#include <uploadqueue.h>
+
+// Lado mayor de los mips que se suben en la primera etapa; el resto se transmite despues
+#define STREAMING_BASE_TEXTURE_SIZE 64
+
+/**
+ * @brief Carga progresiva: primero lo grueso, despues el detalle.
+ *
+ * Con un AssetStreamer, el AssetLoader sube en la primera etapa solo el LOD mas
+ * simple de cada mesh estatico (un proxy compacto) y los mips de hasta
+ * STREAMING_BASE_TEXTURE_SIZE, asi la escena es interactiva sin esperar a que todo
+ * este residente. Lo que falta queda como pedidos pendientes que se atienden de a
+ * pocos, el mas cercano a la camara primero:
+ *  - Mesh: un hilo de trabajo trae a memoria sus paginas del cache proyectado y el
+ *    hilo GL reemplaza el proxy por el mesh completo (Model::refineMesh).
+ *  - Textura: se agregan los mips grandes de a uno y se baja GL_TEXTURE_BASE_LEVEL;
+ *    el id no cambia, asi que todos los que la comparten la ven mas nitida.
+ * La prioridad es Model::viewDistance, que los RenderableObject dejan al dibujar.
+ */
+class AssetStreamer {
+private:
+    // Tiempo maximo por frame para aplicar refinamientos
+    const double UPLOAD_BUDGET_SECONDS = 0.002;
+    // Pedidos en curso a la vez; pocos, para que la prioridad siga mandando
+    const unsigned int MAX_IN_FLIGHT = 2;
+
+    struct Request {
+        float* viewDistance; // del modelo que lo pidio
+        float priority;
+
+        // mesh: reemplazar el proxy meshIndex de model
+        Model* model;
+        size_t meshIndex;
+        std::shared_ptr<ModelData> data;
+
+        // textura: subir los niveles por debajo de residentLevel
+        TextureHandle texture;
+        unsigned int textureId;
+        std::shared_ptr<CompressedImage> image;
+        size_t residentLevel;
+    };
+
+    std::vector<Request> pending;
+    unsigned int inFlight;
+    unsigned int meshesRefined;
+    unsigned int texturesRefined;
+    size_t bytesStreamed;
+    std::chrono::steady_clock::time_point firstRequest;
+
+    // El pool se declara al final para destruirse primero: sus hilos usan la cola
+    UploadQueue uploads;
+    ThreadPool pool;
+
+    void add(Request request) {
+        if (pending.empty() && inFlight == 0) {
+            firstRequest = std::chrono::steady_clock::now();
+            meshesRefined = texturesRefined = 0;
+            bytesStreamed = 0;
+        }
+        request.priority = FLT_MAX;
+        pending.push_back(request);
+    }
+
+    // En el hilo GL, al aplicar (o descartar) un pedido
+    void finishRequest() {
+        inFlight--;
+        if (!isIdle()) return;
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - firstRequest;
+        std::cout << "Streaming complete: " << meshesRefined << " meshes, " << texturesRefined << " textures, "
+            << bytesStreamed / 1024 << " KB | " << elapsed.count() << " ms" << std::endl;
+    }
+
+    void streamMesh(const Request& request) {
+        pool.submit([this, request] {
+            const MeshData& mesh = request.data->meshes[request.meshIndex];
+            MeshGeometry geometry = mesh.geometry();
+            size_t bytes = geometry.vertexBytes() + geometry.indexBytes();
+            prefetchBytes(geometry.vertices, geometry.vertexBytes());
+            prefetchBytes(geometry.indices, geometry.indexBytes());
+
+            uploads.push([this, request, bytes] {
+                if (request.model->refineMesh(request.meshIndex, request.data->meshes[request.meshIndex])) {
+                    meshesRefined++;
+                    bytesStreamed += bytes;
+                }
+                finishRequest();
+            });
+        });
+    }
+
+    void streamTexture(const Request& request) {
+        pool.submit([this, request] {
+            // un trabajo GL por nivel, del mas chico al mas grande: la textura gana nitidez
+            // de a un mip por vez y el presupuesto por frame se respeta
+            for (size_t level = request.residentLevel; level-- > 0;) {
+                const CompressedLevel& mip = request.image->levels[level];
+                prefetchBytes(request.image->bytes() + mip.offset, mip.size);
+
+                uploads.push([this, request, level] {
+                    // una recarga en caliente pudo cambiar el objeto GL detras del handle
+                    if (request.texture->id != request.textureId) {
+                        if (level == 0) finishRequest();
+                        return;
+                    }
+                    uploadCompressedMip(request.textureId, *request.image, level);
+                    bytesStreamed += request.image->levels[level].size;
+                    if (level == 0) {
+                        texturesRefined++;
+                        finishRequest();
+                    }
+                });
+            }
+        });
+    }
+
+public:
+    AssetStreamer(unsigned int numThreads = 1)
+        : inFlight(0), meshesRefined(0), texturesRefined(0), bytesStreamed(0), uploads(64), pool(numThreads) {
+    }
+
+    /**
+     * @brief Los pedidos sin empezar se descartan; los que estan en curso se terminan
+     * de aplicar porque sus hilos pueden estar esperando espacio en la cola.
+     */
+    ~AssetStreamer() {
+        pending.clear();
+        while (inFlight > 0)
+            uploads.drain(UPLOAD_BUDGET_SECONDS);
+    }
+
+    AssetStreamer(const AssetStreamer&) = delete;
+    AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+    /**
+     * @brief Pide el mesh completo para el proxy meshIndex de model (hilo GL).
+     */
+    void requestMesh(Model* model, size_t meshIndex, const std::shared_ptr<ModelData>& data) {
+        Request request = {};
+        request.viewDistance = &model->viewDistance;
+        request.model = model;
+        request.meshIndex = meshIndex;
+        request.data = data;
+        add(request);
+    }
+
+    /**
+     * @brief Pide los mips grandes de una textura creada desde residentLevel (hilo GL).
+     * viewDistance es la del modelo que la uso primero.
+     */
+    void requestTexture(float* viewDistance, const TextureHandle& texture,
+        const std::shared_ptr<CompressedImage>& image, size_t residentLevel) {
+        Request request = {};
+        request.viewDistance = viewDistance;
+        request.texture = texture;
+        request.textureId = texture->id;
+        request.image = image;
+        request.residentLevel = residentLevel;
+        add(request);
+    }
+
+    /**
+     * @brief Una vez por frame en el hilo GL, antes de dibujar: ordena los pedidos por
+     * la distancia del frame anterior, lanza los mas cercanos y aplica los terminados.
+     */
+    void update() {
+        if (!pending.empty()) {
+            for (Request& request : pending)
+                request.priority = *request.viewDistance;
+            // se reinicia para que el proximo render deje la distancia de ese frame
+            for (Request& request : pending)
+                *request.viewDistance = FLT_MAX;
+
+            while (inFlight < MAX_IN_FLIGHT && !pending.empty()) {
+                // min_element se queda con el primero en empates: los no vistos van en orden de pedido
+                auto next = std::min_element(pending.begin(), pending.end(),
+                    [](const Request& a, const Request& b) { return a.priority < b.priority; });
+                Request request = *next;
+                pending.erase(next);
+                inFlight++;
+                if (request.model) streamMesh(request);
+                else streamTexture(request);
+            }
+        }
+        if (!uploads.empty())
+            uploads.drain(UPLOAD_BUDGET_SECONDS);
+    }
+
+    bool isIdle() const { return pending.empty() && inFlight == 0; }
+    size_t getPendingCount() const { return pending.size() + inFlight; }
+};
+
+#endif // ASSET_STREAMER_H
@@ -9,6 +9,7 @@
 
 // Forward declarations de variables globales que se usan
 extern bool isPlayerMoving;
+extern float playerLocomotionSpeed;
 extern float movementSpeedFactor;
 extern float mouseSensitivityFactor;
 extern bool showLightIndicators;
@@ -105,6 +106,10 @@ public:
             isPlayerMoving = true;
         }
 
+        // Velocidad relativa a caminar para el grafo de animacion: 0 quieto, 1 caminando,
+        // runMultiplier corriendo
+        playerLocomotionSpeed = isPlayerMoving ? (isRunning ? runMultiplier : 1.0f) : 0.0f;
+
         // Rotacin con flechas izquierda/derecha
         if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
             rotateCharacter += 0.2f;
@@ -1,6 +1,7 @@
 #ifndef LOADING_SCREEN_H
 #define LOADING_SCREEN_H
 
+#include <algorithm>
 #include <string>
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
@@ -14,10 +15,15 @@ private:
     int totalSteps;
     int currentStep;
     std::string currentMessage;
+    std::string currentTitle;
+    // Progreso dentro del paso actual (recursos cargados en segundo plano)
+    int subCompleted;
+    int subTotal;
 
 public:
     LoadingScreen(GLFWwindow* win, int steps) 
-        : window(win), totalSteps(steps), currentStep(0), currentMessage("Inicializando...") {}
+        : window(win), totalSteps(steps), currentStep(0), currentMessage("Inicializando..."),
+          subCompleted(0), subTotal(0) {}
 
     void updateProgress(const std::string& message) {
         currentStep++;
@@ -25,16 +31,50 @@ public:
         render();
     }
 
+    /**
+     * @brief Avance de los recursos del paso actual; se llama cada frame mientras
+     * el AssetLoader vacia su cola de subida.
+     */
+    void setSubProgress(int completed, int total) {
+        subCompleted = completed;
+        subTotal = total;
+    }
+
     void render() {
         glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Aqu podras dibujar una barra de progreso simple
-        // Por ahora solo actualizamos la ventana
-        float progress = (float)currentStep / (float)totalSteps * 100.0f;
-        
+        float fraction = (float)currentStep;
+        if (subTotal > 0)
+            fraction += (float)subCompleted / (float)subTotal;
+        fraction = std::min(fraction / (float)totalSteps, 1.0f);
+        float progress = fraction * 100.0f;
+
+        // Barra de progreso simple con glScissor (no necesita shaders)
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        int barWidth = width * 3 / 5;
+        int barHeight = std::max(height / 40, 4);
+        int barX = (width - barWidth) / 2;
+        int barY = height / 4;
+
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(barX, barY, barWidth, barHeight);
+        glClearColor(0.25f, 0.25f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glScissor(barX, barY, (int)(barWidth * fraction), barHeight);
+        glClearColor(0.8f, 0.8f, 0.9f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
+
+        // Cambiar el titulo solo cuando cambia el texto: es caro hacerlo cada frame
         std::string title = "Cargando... " + std::to_string((int)progress) + "% - " + currentMessage;
-        glfwSetWindowTitle(window, title.c_str());
+        if (subTotal > 0)
+            title += " (" + std::to_string(subCompleted) + "/" + std::to_string(subTotal) + ")";
+        if (title != currentTitle) {
+            glfwSetWindowTitle(window, title.c_str());
+            currentTitle = title;
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
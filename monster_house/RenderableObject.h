@@ -13,6 +13,14 @@
 // Forward declaration
 class LightManager;
 
+// Seleccion de LOD: error geometrico maximo tolerado en pantalla (pixeles)
+#define LOD_PIXEL_ERROR 1.5f
+// Banda de histeresis: para bajar de detalle el error debe quedar este porcentaje por debajo
+#define LOD_HYSTERESIS 0.25f
+// Objetos con un diametro proyectado menor a esto no se dibujan
+#define LOD_CULL_PIXELS 1.0f
+#define LOD_CULLED 0xFFFFFFFFu
+
 /**
  * @brief Objeto base renderizable
  */
@@ -35,6 +43,31 @@ protected:
     bool useHierarchicalTransform;
     glm::mat4 hierarchicalTransform;
 
+    // Nivel de detalle elegido en el ultimo frame (base de la histeresis)
+    unsigned int currentLod;
+
+    // Volumen en espacio de mundo. Las subclases escriben position/rotation directamente,
+    // asi que en vez de una bandera se guarda una copia de las entradas de getModelMatrix()
+    // (y del volumen local, que cambia mientras el modelo termina de cargarse)
+    struct TransformSnapshot {
+        glm::vec3 position, rotation, scale, initialRotation, initialTranslation;
+        glm::mat4 hierarchicalTransform;
+        bool useHierarchicalTransform;
+        glm::vec3 localCenter;
+        float localRadius;
+
+        bool operator==(const TransformSnapshot& other) const {
+            return position == other.position && rotation == other.rotation && scale == other.scale &&
+                initialRotation == other.initialRotation && initialTranslation == other.initialTranslation &&
+                useHierarchicalTransform == other.useHierarchicalTransform &&
+                hierarchicalTransform == other.hierarchicalTransform &&
+                localCenter == other.localCenter && localRadius == other.localRadius;
+        }
+    };
+    mutable Bounds worldBounds;
+    mutable TransformSnapshot worldBoundsKey;
+    mutable bool worldBoundsValid;
+
 public:
     // Constructor para objetos con seguimiento (ej. jugador)
     RenderableObject(Model* mdl, Shader* shdr, glm::vec3* extPos = nullptr,
@@ -45,7 +78,8 @@ public:
           rotation(extRot ? glm::vec3(0.0f, *extRot, 0.0f) : glm::vec3(0.0f)),
           scale(scl), initialRotation(initRot), initialTranslation(initTrans),
           useBlending(false), externalPosition(extPos), externalRotation(extRot),
-          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)) {
+          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)), currentLod(0),
+          worldBounds(Bounds::empty()), worldBoundsValid(false) {
         setDefaultMaterial();
     }
 
@@ -55,7 +89,8 @@ public:
         : model(mdl), shader(shdr), position(pos), rotation(rot), scale(scl),
           initialRotation(glm::vec3(0.0f)), initialTranslation(glm::vec3(0.0f)),
           useBlending(false), externalPosition(nullptr), externalRotation(nullptr),
-          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)) {
+          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)), currentLod(0),
+          worldBounds(Bounds::empty()), worldBoundsValid(false) {
         setDefaultMaterial();
     }
 
@@ -108,6 +143,10 @@ public:
         const LightManager& lightManager, const glm::vec3& eyePosition) {
         if (!model || !shader) return;
 
+        unsigned int lod = selectLod(projection, eyePosition);
+        if (lod == LOD_CULLED) return;
+        glm::mat4 modelMatrix = getModelMatrix();
+
         shader->use();
 
         if (useBlending) {
@@ -117,7 +156,7 @@ public:
 
         shader->setMat4("projection", projection);
         shader->setMat4("view", view);
-        shader->setMat4("model", getModelMatrix());
+        shader->setMat4("model", modelMatrix);
 
         // Aplicar luces globales + locales
         lightManager.applyLights(shader, affectedLights);
@@ -133,10 +172,80 @@ public:
             glBindTexture(GL_TEXTURE_2D, 0);
         }
 
-        model->Draw(*shader);
+        // descarte por meshlets en el nivel completo: frustum siempre, cono de normales
+        // solo si GL_CULL_FACE esta activo (si no, las caras traseras tambien se dibujan)
+        MeshletCuller culler = MeshletCuller::fromMatrices(projection * view * modelMatrix, modelMatrix,
+            eyePosition, glIsEnabled(GL_CULL_FACE) == GL_TRUE);
+        model->Draw(*shader, lod, &culler);
         glUseProgram(0);
     }
 
+    /**
+     * @brief Elige el nivel de detalle segun el tamano proyectado en pantalla.
+     *
+     * Usa el nivel mas simple cuyo error geometrico proyectado no pasa de
+     * LOD_PIXEL_ERROR. Para bajar de detalle exige quedar LOD_HYSTERESIS por debajo
+     * del umbral, asi un objeto en el limite no alterna de nivel cada frame.
+     * Devuelve LOD_CULLED si el objeto ocupa menos de LOD_CULL_PIXELS.
+     */
+    unsigned int selectLod(const glm::mat4& projection, const glm::vec3& eyePosition) {
+        const Bounds& bounds = getWorldBounds();
+        float localRadius = model ? model->getBoundingRadius() : 0.0f;
+        unsigned int lodCount = model ? model->getLodCount() : 1;
+        if (bounds.isEmpty() || localRadius <= 0.0f) return 0;
+
+        float distance = glm::length(bounds.center - eyePosition) - bounds.radius;
+        model->viewDistance = std::min(model->viewDistance, std::max(distance, 0.0f));
+        if (distance <= 0.0f) {
+            currentLod = 0; // la camara esta dentro de la esfera envolvente
+            return currentLod;
+        }
+
+        // pixeles que ocupa una unidad del mundo a esa distancia; el error de los LODs
+        // esta en unidades del modelo, por eso se escala por la escala de la matriz.
+        // El alto sale del viewport actual, que sigue los cambios de tamano de la ventana.
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        float pixelsPerUnit = projection[1][1] * 0.5f * (float)viewport[3] / distance;
+        if (2.0f * bounds.radius * pixelsPerUnit < LOD_CULL_PIXELS) return LOD_CULLED;
+        pixelsPerUnit *= bounds.radius / localRadius;
+
+        unsigned int lod = std::min(currentLod, lodCount - 1);
+        while (lod + 1 < lodCount &&
+            model->getLodError(lod + 1) * pixelsPerUnit <= LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS))
+            lod++;
+        while (lod > 0 && model->getLodError(lod) * pixelsPerUnit > LOD_PIXEL_ERROR)
+            lod--;
+
+        currentLod = lod;
+        return currentLod;
+    }
+
+    /**
+     * @brief Volumen envolvente del modelo en su propio espacio (vacio si no hay modelo).
+     */
+    virtual Bounds getLocalBounds() const {
+        return model ? model->bounds : Bounds::empty();
+    }
+
+    /**
+     * @brief Volumen envolvente en espacio de mundo, derivado de getModelMatrix().
+     *
+     * Se recalcula solo cuando cambia alguna entrada de la transformacion o el
+     * volumen local; el resto de las llamadas devuelve la copia guardada.
+     */
+    const Bounds& getWorldBounds() const {
+        Bounds local = getLocalBounds();
+        TransformSnapshot key = { position, rotation, scale, initialRotation, initialTranslation,
+            hierarchicalTransform, useHierarchicalTransform, local.center, local.radius };
+        if (!worldBoundsValid || !(key == worldBoundsKey)) {
+            worldBounds = local.transformed(getModelMatrix());
+            worldBoundsKey = key;
+            worldBoundsValid = true;
+        }
+        return worldBounds;
+    }
+
     // Setters
     void setPosition(const glm::vec3& pos) { position = pos; }
     void setRotation(const glm::vec3& rot) { rotation = rot; }
@@ -202,6 +311,7 @@ public:
     const std::vector<size_t>& getAffectedLights() const { return affectedLights; }
     glm::vec3 getPosition() const { return position; }
     bool isUsingHierarchicalTransform() const { return useHierarchicalTransform; }
+    unsigned int getCurrentLod() const { return currentLod; }
 
 private:
     void setDefaultMaterial() {
@@ -0,0 +1,92 @@
+// Herramienta de linea de comandos (sin ventana ni OpenGL) que cocina todos los assets
+// de monster_house/models y monster_house/textures con el mismo pipeline del juego.
+// Los artefactos quedan junto a cada fuente (.mhc / .cooked.dds; las seis caras de un
+// cubemap en un solo .cubemap.cooked.dds) y solo se regeneran si cambio la fuente.
+//
+// Al final empaqueta todo (y los shaders) en <root>/assets.mhp, que el juego monta al arrancar.
+//
+// Uso: asset_cooker [--root dir] [--threads n] [--merge archivo.fbx]... [--manifest ruta]
+//                   [--pack ruta | --no-pack] [--force]
+// La casa se carga con mergeStaticMeshes, asi que el juego espera:
+//   asset_cooker --merge MonsterHouseFinal.fbx
+// (Release|x64 de viaje_lunar lo ejecuta asi como evento previo a la compilacion.)
+//
+// asset_cooker --bench-skin mide gatherSkinWeights sobre meshes sinteticas y
+// asset_cooker --bench-keys la evaluacion de claves del skeleton; los dos terminan sin
+// cocinar nada (ver cookerbench.h).
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <assetcooker.h>
+#include <cookerbench.h>
+
+static void printUsage()
+{
+	std::cout << "usage: asset_cooker [--root dir] [--threads n] [--merge file.fbx]... [--manifest path] [--pack path | --no-pack] [--force]" << std::endl
+		<< "       asset_cooker --bench-skin | --bench-keys" << std::endl
+		<< "  --root      directory holding models/ and textures/ (default monster_house)" << std::endl
+		<< "  --threads   worker threads (default: hardware threads - 1)" << std::endl
+		<< "  --merge     cook this model with mergeStaticMeshes (repeatable)" << std::endl
+		<< "  --manifest  manifest output (default <root>/cooked_manifest.txt)" << std::endl
+		<< "  --pack      asset pack output (default <root>/assets" ASSET_PACK_EXTENSION ")" << std::endl
+		<< "  --no-pack   leave the cooked files loose" << std::endl
+		<< "  --force     recook even when the cooked artifact is up to date" << std::endl
+		<< "  --bench-skin  time skin weight gathering on synthetic meshes and exit" << std::endl
+		<< "  --bench-keys  time keyframe playback and seeks on a synthetic clip and exit" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	CookSettings settings;
+	std::string manifestPath, packPath;
+	bool writePack = true;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!strcmp(argv[i], "--root") && hasValue) settings.root = argv[++i];
+		else if (!strcmp(argv[i], "--threads") && hasValue) settings.threads = (unsigned int)atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--merge") && hasValue) settings.mergeModels.push_back(argv[++i]);
+		else if (!strcmp(argv[i], "--manifest") && hasValue) manifestPath = argv[++i];
+		else if (!strcmp(argv[i], "--pack") && hasValue) packPath = argv[++i];
+		else if (!strcmp(argv[i], "--no-pack")) writePack = false;
+		else if (!strcmp(argv[i], "--force")) settings.force = true;
+		else if (!strcmp(argv[i], "--bench-skin")) {
+			benchSkinWeights();
+			return 0;
+		}
+		else if (!strcmp(argv[i], "--bench-keys")) {
+			benchKeyframes();
+			return 0;
+		}
+		else {
+			printUsage();
+			return strcmp(argv[i], "--help") ? 2 : 0;
+		}
+	}
+	if (manifestPath.empty())
+		manifestPath = settings.root + "/cooked_manifest.txt";
+	if (packPath.empty())
+		packPath = settings.root + "/assets" ASSET_PACK_EXTENSION;
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<CookedAsset> assets = cookAssets(settings);
+	printCookSummary(assets, millisecondsSince(start));
+
+	if (!writeCookManifest(manifestPath, assets)) {
+		std::cout << "ERROR::ASSET_COOKER:: could not write " << manifestPath << std::endl;
+		return 1;
+	}
+	std::cout << "Manifest: " << manifestPath << std::endl;
+
+	if (writePack && !writeAssetPack(settings.root, assets, packPath)) {
+		std::cout << "ERROR::ASSET_COOKER:: could not write " << packPath << std::endl;
+		return 1;
+	}
+
+	for (const CookedAsset& asset : assets)
+		if (asset.status == COOK_STATUS_FAILED) return 1;
+	return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef ANIMATIONPROFILE_H
+#define ANIMATIONPROFILE_H
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Con 1 se mide el costo de las poses (clip, grafo de mezclas y multitudes) y se
+// imprime un promedio por etiqueta despues de ANIMATION_PROFILE_SAMPLES llamadas. Con 0
+// AnimationTimer no hace nada: ni lee el reloj ni guarda estado en los Animator.
+#ifndef ANIMATION_PROFILE
+#define ANIMATION_PROFILE 0
+#endif
+
+#define ANIMATION_PROFILE_SAMPLES 600
+
+#if ANIMATION_PROFILE
+// Acumulado de todo el proceso por etiqueta; los updates pueden venir de varios hilos
+inline void recordAnimationTime(const char* label, double micros)
+{
+	struct Samples { double micros = 0.0; int count = 0; };
+	static std::map<std::string, Samples> samples;
+	static std::mutex mutex;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	Samples& entry = samples[label];
+	if (entry.count >= ANIMATION_PROFILE_SAMPLES) return;
+	entry.micros += micros;
+	if (++entry.count == ANIMATION_PROFILE_SAMPLES)
+		std::cout << "Animation profile: " << label << " | " << entry.micros / entry.count << " us/call" << std::endl;
+}
+#endif
+
+// Mide su propio alcance: { AnimationTimer timer("pose"); evaluatePose(); }
+struct AnimationTimer
+{
+#if ANIMATION_PROFILE
+	const char* label;
+	std::chrono::steady_clock::time_point start;
+
+	explicit AnimationTimer(const char* label) : label(label), start(std::chrono::steady_clock::now()) {}
+	~AnimationTimer()
+	{
+		recordAnimationTime(label, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+	}
+#else
+	explicit AnimationTimer(const char*) {}
+#endif
+
+	AnimationTimer(const AnimationTimer&) = delete;
+	AnimationTimer& operator=(const AnimationTimer&) = delete;
+};
+
+#endif
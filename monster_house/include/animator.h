@@ -0,0 +1,262 @@
+#ifndef ANIMATOR_H
+#define ANIMATOR_H
+
+#include <animatedmodel.h>
+#include <animationprofile.h>
+#include <animgraph.h>
+
+#include <cassert>
+#include <cmath>
+
+// ============================================================================
+// ANIMATOR
+// Estado de reproduccion de una instancia de un AnimatedModel: clip, instante, cursores
+// de claves y paleta de huesos. El modelo (meshes, skeleton compilado y clips) se carga
+// una vez y se comparte sin cambios; cada personaje que lo usa tiene su Animator, con un
+// costo fijo: MAX_RIGGING_BONES matrices y un KeyCursor por nodo.
+//
+// Sin grafo reproduce un clip en bucle. Con setGraph() sigue un AnimationGraph: sus
+// parametros, el estado actual y, durante un crossfade, el anterior.
+// ============================================================================
+
+class Animator
+{
+public:
+	Animator(const AnimatedModel* model = nullptr, unsigned int clip = 0) : model(model), clip(clip), time(0.0f)
+	{
+		for (unsigned int i = 0; i < MAX_RIGGING_BONES; i++)
+			bones[i] = glm::mat4(1.0f);
+		evaluatePose();
+	}
+
+	const AnimatedModel* getModel() const { return model; }
+	unsigned int getClip() const { return clip; }
+	float getTime() const { return time; }
+
+	// Paleta para el uniform gBones
+	const glm::mat4* getBones() const { return bones; }
+
+	// El clip existe y tiene al menos dos cuadros (con el modelo ya cargado); con grafo,
+	// que el modelo tenga skeleton y el grafo estados
+	bool isPlayable() const
+	{
+		if (graph)
+			return model && model->skeleton.getNodeCount() > 0 && state >= 0;
+		return model && clip < model->skeleton.getClipCount() && model->getClipFrames(clip) > 1.0;
+	}
+
+	/**
+	 * Reproduce graph (armado para el mismo modelo) desde su primer estado. Reserva aqui
+	 * el estado por instancia; actualizar no vuelve a pedir memoria.
+	 */
+	void setGraph(const AnimationGraph* newGraph)
+	{
+		assert(!newGraph || newGraph->getModel() == model);
+		graph = newGraph;
+		state = previousState = -1;
+		phase = previousPhase = 0.0f;
+		fadeElapsed = fadeSeconds = 0.0f;
+		if (!graph) return;
+
+		parameters.resize(graph->getParameterCount());
+		for (size_t i = 0; i < parameters.size(); i++)
+			parameters[i] = graph->getParameterDefault((int)i);
+		blendParameters = parameters;
+		nodeCursors.assign(graph->getNodeCount(), AnimationCursor());
+		if (!graph->getStates().empty())
+			state = 0;
+		evaluateGraph();
+	}
+
+	const AnimationGraph* getGraph() const { return graph; }
+	int getState() const { return state; }
+
+	void setParameter(int parameter, float value)
+	{
+		if (parameter >= 0 && parameter < (int)parameters.size())
+			parameters[parameter] = value;
+	}
+
+	float getParameter(int parameter) const { return parameters[parameter]; }
+
+	// Valor que usan las mezclas: el asignado, o su version suavizada si el parametro
+	// tiene suavizado en el grafo
+	float getBlendParameter(int parameter) const { return blendParameters[parameter]; }
+
+	// Pasa al estado target mezclando durante seconds. Si ya habia un crossfade, el
+	// estado que salia se descarta y sale el actual.
+	void crossFade(int target, float seconds)
+	{
+		if (!graph || target == state || target < 0 || target >= (int)graph->getStates().size()) return;
+		previousState = seconds > 0.0f ? state : -1;
+		previousPhase = phase;
+		state = target;
+		phase = 0.0f;
+		fadeElapsed = 0.0f;
+		fadeSeconds = seconds;
+	}
+
+	// Cambia de clip desde el inicio
+	void setClip(unsigned int newClip)
+	{
+		clip = newClip;
+		time = 0.0f;
+		evaluatePose();
+	}
+
+	// Salta al instante ticks del clip (se envuelve a su duracion). Sin efecto con grafo.
+	void setTime(float ticks)
+	{
+		if (graph || !isPlayable()) return;
+		time = wrapTime(ticks);
+		evaluatePose();
+	}
+
+	// Avanza el clip deltaTime segundos y recalcula la pose
+	void update(float deltaTime)
+	{
+		if (graph) {
+			updateGraph(deltaTime);
+			return;
+		}
+		if (!advance(deltaTime)) return;
+
+		AnimationTimer timer("clip pose");
+		evaluatePose();
+	}
+
+	/**
+	 * Como update() para count animators del mismo modelo y clip, con una sola
+	 * evaluacion por lotes del skeleton compartido (ver CompiledSkeleton::evaluateBatch).
+	 */
+	static void updateBatch(Animator* const* animators, size_t count, float deltaTime)
+	{
+		if (count == 0 || !animators[0]->isPlayable()) return;
+		const AnimatedModel* model = animators[0]->model;
+		unsigned int clip = animators[0]->clip;
+
+		// arreglos de trabajo propios de cada hilo, para no reservar en cada frame
+		static thread_local vector<float> times;
+		static thread_local vector<AnimationCursor*> cursors;
+		static thread_local vector<glm::mat4*> outputs;
+		times.resize(count);
+		cursors.resize(count);
+		outputs.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			Animator& animator = *animators[i];
+			assert(animator.model == model && animator.clip == clip && !animator.graph);
+			animator.advance(deltaTime);
+			times[i] = animator.time;
+			cursors[i] = &animator.cursor;
+			outputs[i] = animator.bones;
+		}
+		model->skeleton.evaluateBatch(clip, count, times.data(), cursors.data(),
+			model->m_GlobalInverseTransform, outputs.data(), MAX_RIGGING_BONES);
+	}
+
+private:
+	const AnimatedModel* model;
+	unsigned int         clip;
+	float                time;   // ticks del clip, de 0 a frames - 1
+	AnimationCursor      cursor; // ultima clave usada por canal en esta reproduccion
+	glm::mat4            bones[MAX_RIGGING_BONES];
+
+	// Con grafo: parametros (asignados y suavizados), un cursor por nodo del arbol, y
+	// fase (0 a 1) del estado actual y del que sale durante un crossfade
+	const AnimationGraph*   graph = nullptr;
+	vector<float>           parameters;
+	vector<float>           blendParameters;
+	vector<AnimationCursor> nodeCursors;
+	int                     state = -1;
+	int                     previousState = -1;
+	float                   phase = 0.0f;
+	float                   previousPhase = 0.0f;
+	float                   fadeElapsed = 0.0f;
+	float                   fadeSeconds = 0.0f;
+
+	float wrapTime(float ticks) const
+	{
+		float length = (float)(model->getClipFrames(clip) - 1.0);
+		ticks = std::fmod(ticks, length);
+		return ticks < 0.0f ? ticks + length : ticks;
+	}
+
+	bool advance(float deltaTime)
+	{
+		if (!isPlayable()) return false;
+		time = wrapTime(time + deltaTime * (float)model->getClipFramerate(clip));
+		return true;
+	}
+
+	float advancePhase(int target, float current, float deltaTime) const
+	{
+		float duration = graph->getDuration(graph->getStates()[target].root, blendParameters.data());
+		if (duration <= 0.0f) return current;
+		float next = std::fmod(current + deltaTime / duration, 1.0f);
+		if (next < 0.0f) next += 1.0f;
+		return next < 1.0f ? next : 0.0f;
+	}
+
+	// Acerca los parametros de las mezclas a los asignados; sin suavizado los copia
+	void smoothParameters(float deltaTime)
+	{
+		for (size_t i = 0; i < parameters.size(); i++) {
+			float seconds = graph->getParameterSmoothing((int)i);
+			if (seconds <= 0.0f)
+				blendParameters[i] = parameters[i];
+			else
+				blendParameters[i] += (parameters[i] - blendParameters[i]) * (1.0f - std::exp(-deltaTime / seconds));
+		}
+	}
+
+	void updateGraph(float deltaTime)
+	{
+		if (!isPlayable()) return;
+		int transition = graph->findTransition(state, parameters.data());
+		if (transition >= 0) {
+			const AnimationTransition& next = graph->getTransitions()[transition];
+			crossFade(next.to, next.fadeSeconds);
+		}
+		smoothParameters(deltaTime);
+
+		phase = advancePhase(state, phase, deltaTime);
+		if (previousState >= 0) {
+			previousPhase = advancePhase(previousState, previousPhase, deltaTime);
+			fadeElapsed += deltaTime;
+			if (fadeElapsed >= fadeSeconds)
+				previousState = -1;
+		}
+
+		AnimationTimer timer("blend graph pose");
+		evaluateGraph();
+	}
+
+	void evaluateGraph()
+	{
+		if (!isPlayable()) return;
+		PosePool& pool = PosePool::forThread();
+		PosePool::Scope scope(pool);
+		size_t count = model->skeleton.getNodeCount();
+		NodeTransform* pose = pool.acquire(count);
+		const vector<AnimationState>& states = graph->getStates();
+		graph->evaluate(states[state].root, phase, blendParameters.data(), nodeCursors.data(), pool, pose);
+		if (previousState >= 0) {
+			NodeTransform* outgoing = pool.acquire(count);
+			graph->evaluate(states[previousState].root, previousPhase, blendParameters.data(), nodeCursors.data(), pool, outgoing);
+			blendPoses(outgoing, pose, fadeElapsed / fadeSeconds, pose, count);
+		}
+		model->skeleton.composePose(pose, model->m_GlobalInverseTransform, bones, MAX_RIGGING_BONES);
+	}
+
+	void evaluatePose()
+	{
+		if (graph) {
+			evaluateGraph();
+			return;
+		}
+		if (!isPlayable()) return;
+		model->skeleton.evaluate(clip, time, model->m_GlobalInverseTransform, cursor, bones, MAX_RIGGING_BONES);
+	}
+};
+
+#endif
@@ -0,0 +1,381 @@
+#ifndef ANIMGRAPH_H
+#define ANIMGRAPH_H
+
+#include <animatedmodel.h>
+#include <posepool.h>
+
+#include <cassert>
+#include <utility>
+
+// ============================================================================
+// ARBOL DE MEZCLA Y MAQUINA DE ESTADOS
+// Un AnimationGraph se arma una vez por modelo y se comparte entre instancias (el
+// estado de cada una esta en su Animator). Nodos del arbol:
+//  - Clip:     un clip del modelo, con multiplicador de velocidad.
+//  - Blend 1D: mezcla los dos hijos vecinos segun un parametro (caminar/correr).
+//  - Blend 2D: mezcla todos los hijos por distancia inversa a un punto de dos parametros.
+//  - Aditivo:  suma a la base la diferencia entre una capa y su pose de referencia
+//              (el clip de referencia en t = 0), con un parametro como peso.
+// Los hijos de un estado avanzan en fase (tiempo normalizado), asi un paso de caminar y
+// uno de correr quedan alineados al mezclarse. Los estados pasan de uno a otro con un
+// crossfade cuando se cumple una transicion (parametro mayor o menor que un umbral).
+// Un parametro puede tener suavizado: las mezclas ven un valor que sigue al asignado
+// sin saltos, mientras que las transiciones se deciden con el valor asignado.
+//
+// Las mezclas se hacen sobre poses locales (NodeTransform) y los buffers intermedios
+// salen del PosePool del hilo: evaluar no reserva memoria.
+// ============================================================================
+
+enum BlendNodeType {
+	BLEND_NODE_CLIP,
+	BLEND_NODE_1D,
+	BLEND_NODE_2D,
+	BLEND_NODE_ADDITIVE
+};
+
+struct BlendNode {
+	BlendNodeType     type;
+	unsigned int      clip = 0;        // clip: clip del modelo; aditivo: clip de referencia
+	float             speed = 1.0f;    // clip: multiplicador de velocidad
+	int               parameterX = -1; // 1D/2D: parametro; aditivo: peso (-1 = peso 1)
+	int               parameterY = -1; // 2D
+	vector<int>       children;        // aditivo: base y capa
+	vector<glm::vec2> positions;       // 1D: umbral en x, ascendente; 2D: posicion de cada hijo
+};
+
+enum TransitionCondition {
+	TRANSITION_GREATER,
+	TRANSITION_LESS
+};
+
+struct AnimationState {
+	string name;
+	int    root; // nodo del arbol
+};
+
+struct AnimationTransition {
+	int                 from; // -1: desde cualquier estado
+	int                 to;
+	int                 parameter;
+	TransitionCondition condition;
+	float               threshold;
+	float               fadeSeconds;
+};
+
+// Mezcla lineal de poses: position y scale con lerp, rotacion con nlerp.
+// out puede ser a o b.
+inline void blendPoses(const NodeTransform* a, const NodeTransform* b, float weight, NodeTransform* out, size_t count)
+{
+	for (size_t n = 0; n < count; n++) {
+		out[n].position = a[n].position + weight * (b[n].position - a[n].position);
+		out[n].scale = a[n].scale + weight * (b[n].scale - a[n].scale);
+		out[n].rotation = quatNlerp(a[n].rotation, b[n].rotation, weight);
+	}
+}
+
+// Capa aditiva: base + weight * (layer - reference), con la diferencia de rotacion
+// aplicada despues de la base. out puede ser base.
+inline void addPose(const NodeTransform* base, const NodeTransform* layer, const NodeTransform* reference,
+	float weight, NodeTransform* out, size_t count)
+{
+	const glm::vec4 identity(0.0f, 0.0f, 0.0f, 1.0f);
+	for (size_t n = 0; n < count; n++) {
+		glm::vec4 delta = quatMultiply(quatConjugate(reference[n].rotation), layer[n].rotation);
+		out[n].position = base[n].position + weight * (layer[n].position - reference[n].position);
+		out[n].scale = base[n].scale * (glm::vec3(1.0f) + weight * (layer[n].scale / reference[n].scale - glm::vec3(1.0f)));
+		out[n].rotation = glm::normalize(quatMultiply(base[n].rotation, quatNlerp(identity, delta, weight)));
+	}
+}
+
+class AnimationGraph
+{
+public:
+	explicit AnimationGraph(const AnimatedModel* model) : model(model) {}
+
+	// ------------------------------------------------------------------------
+	// Construccion (una vez, al cargar)
+	// ------------------------------------------------------------------------
+
+	// Con smoothingSeconds > 0 el valor que usan las mezclas se acerca al asignado en
+	// forma exponencial, con esa constante de tiempo (ver Animator::update)
+	int addParameter(const string& name, float defaultValue = 0.0f, float smoothingSeconds = 0.0f)
+	{
+		parameterNames.push_back(name);
+		parameterDefaults.push_back(defaultValue);
+		parameterSmoothing.push_back(smoothingSeconds);
+		return (int)parameterNames.size() - 1;
+	}
+
+	int addClip(unsigned int clip, float speed = 1.0f)
+	{
+		BlendNode node;
+		node.type = BLEND_NODE_CLIP;
+		node.clip = clip;
+		node.speed = speed;
+		return addNode(node);
+	}
+
+	// children: (umbral, nodo), en cualquier orden
+	int addBlend1D(int parameter, vector<std::pair<float, int>> children)
+	{
+		assert(!children.empty());
+		std::sort(children.begin(), children.end(),
+			[](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first < b.first; });
+		BlendNode node;
+		node.type = BLEND_NODE_1D;
+		node.parameterX = parameter;
+		for (const std::pair<float, int>& child : children) {
+			node.positions.push_back(glm::vec2(child.first, 0.0f));
+			node.children.push_back(child.second);
+		}
+		return addNode(node);
+	}
+
+	// children: (posicion en el plano de los dos parametros, nodo)
+	int addBlend2D(int parameterX, int parameterY, const vector<std::pair<glm::vec2, int>>& children)
+	{
+		assert(!children.empty());
+		BlendNode node;
+		node.type = BLEND_NODE_2D;
+		node.parameterX = parameterX;
+		node.parameterY = parameterY;
+		for (const std::pair<glm::vec2, int>& child : children) {
+			node.positions.push_back(child.first);
+			node.children.push_back(child.second);
+		}
+		return addNode(node);
+	}
+
+	int addAdditive(int base, int layer, unsigned int referenceClip, int weightParameter = -1)
+	{
+		BlendNode node;
+		node.type = BLEND_NODE_ADDITIVE;
+		node.clip = referenceClip;
+		node.parameterX = weightParameter;
+		node.children = { base, layer };
+		return addNode(node);
+	}
+
+	int addState(const string& name, int root)
+	{
+		states.push_back(AnimationState{ name, root });
+		return (int)states.size() - 1;
+	}
+
+	void addTransition(int from, int to, int parameter, TransitionCondition condition, float threshold, float fadeSeconds)
+	{
+		transitions.push_back(AnimationTransition{ from, to, parameter, condition, threshold, fadeSeconds });
+	}
+
+	// ------------------------------------------------------------------------
+	// Consulta
+	// ------------------------------------------------------------------------
+
+	const AnimatedModel* getModel() const { return model; }
+	size_t getNodeCount() const { return nodes.size(); }
+	size_t getParameterCount() const { return parameterNames.size(); }
+	float getParameterDefault(int parameter) const { return parameterDefaults[parameter]; }
+	float getParameterSmoothing(int parameter) const { return parameterSmoothing[parameter]; }
+	const vector<AnimationState>& getStates() const { return states; }
+	const vector<AnimationTransition>& getTransitions() const { return transitions; }
+
+	int findParameter(const string& name) const
+	{
+		auto found = std::find(parameterNames.begin(), parameterNames.end(), name);
+		return found != parameterNames.end() ? (int)(found - parameterNames.begin()) : -1;
+	}
+
+	int findState(const string& name) const
+	{
+		for (size_t i = 0; i < states.size(); i++)
+			if (states[i].name == name) return (int)i;
+		return -1;
+	}
+
+	// Primera transicion que se cumple desde state, o -1
+	int findTransition(int state, const float* parameters) const
+	{
+		for (size_t i = 0; i < transitions.size(); i++) {
+			const AnimationTransition& transition = transitions[i];
+			if ((transition.from != state && transition.from != -1) || transition.to == state) continue;
+			float value = parameters[transition.parameter];
+			if (transition.condition == TRANSITION_GREATER ? value > transition.threshold : value < transition.threshold)
+				return (int)i;
+		}
+		return -1;
+	}
+
+	// Duracion de una vuelta del nodo en segundos con los pesos actuales (0 si no avanza)
+	float getDuration(int index, const float* parameters) const
+	{
+		const BlendNode& node = nodes[index];
+		switch (node.type) {
+		case BLEND_NODE_CLIP: {
+			if (!isValidClip(node.clip)) return 0.0f;
+			double ticksPerSecond = model->getClipFramerate(node.clip) * node.speed;
+			return ticksPerSecond > 0.0 ? (float)((model->getClipFrames(node.clip) - 1.0) / ticksPerSecond) : 0.0f;
+		}
+		case BLEND_NODE_1D: {
+			int first, second;
+			float factor = weights1D(node, parameters, first, second);
+			float a = getDuration(node.children[first], parameters);
+			return a + factor * (getDuration(node.children[second], parameters) - a);
+		}
+		case BLEND_NODE_2D: {
+			float total = weightTotal2D(node, parameters);
+			float duration = 0.0f;
+			for (size_t i = 0; i < node.children.size(); i++) {
+				float weight = weight2D(node, parameters, i, total);
+				if (weight > 0.0f) duration += weight * getDuration(node.children[i], parameters);
+			}
+			return duration;
+		}
+		case BLEND_NODE_ADDITIVE:
+			return getDuration(node.children[0], parameters);
+		}
+		return 0.0f;
+	}
+
+	/**
+	 * Pose local del nodo en la fase phase (0 a 1) en out (una entrada por nodo del
+	 * skeleton). cursors tiene uno por nodo del arbol; los intermedios salen de pool.
+	 */
+	void evaluate(int index, float phase, const float* parameters, AnimationCursor* cursors,
+		PosePool& pool, NodeTransform* out) const
+	{
+		const BlendNode& node = nodes[index];
+		size_t count = model->skeleton.getNodeCount();
+		PosePool::Scope scope(pool);
+
+		switch (node.type) {
+		case BLEND_NODE_CLIP:
+			if (!isValidClip(node.clip)) {
+				std::fill(out, out + count, identityTransform());
+				return;
+			}
+			model->skeleton.sampleLocalPose(node.clip, phase * (float)(model->getClipFrames(node.clip) - 1.0),
+				cursors[index], out);
+			return;
+
+		case BLEND_NODE_1D: {
+			int first, second;
+			float factor = weights1D(node, parameters, first, second);
+			evaluate(node.children[first], phase, parameters, cursors, pool, out);
+			if (factor <= 0.0f) return;
+			NodeTransform* other = pool.acquire(count);
+			evaluate(node.children[second], phase, parameters, cursors, pool, other);
+			blendPoses(out, other, factor, out, count);
+			return;
+		}
+
+		case BLEND_NODE_2D: {
+			// acumulado: cada hijo entra con su peso sobre el total ya mezclado
+			float total = weightTotal2D(node, parameters);
+			float accumulated = 0.0f;
+			NodeTransform* child = pool.acquire(count);
+			for (size_t i = 0; i < node.children.size(); i++) {
+				float weight = weight2D(node, parameters, i, total);
+				if (weight <= 0.0f) continue;
+				if (accumulated == 0.0f) {
+					evaluate(node.children[i], phase, parameters, cursors, pool, out);
+				}
+				else {
+					evaluate(node.children[i], phase, parameters, cursors, pool, child);
+					blendPoses(out, child, weight / (accumulated + weight), out, count);
+				}
+				accumulated += weight;
+			}
+			return;
+		}
+
+		case BLEND_NODE_ADDITIVE: {
+			evaluate(node.children[0], phase, parameters, cursors, pool, out);
+			float weight = node.parameterX >= 0 ? parameters[node.parameterX] : 1.0f;
+			if (weight <= 0.0f || !isValidClip(node.clip)) return;
+			NodeTransform* layer = pool.acquire(count);
+			NodeTransform* reference = pool.acquire(count);
+			evaluate(node.children[1], phase, parameters, cursors, pool, layer);
+			model->skeleton.sampleLocalPose(node.clip, 0.0f, cursors[index], reference);
+			addPose(out, layer, reference, weight, out, count);
+			return;
+		}
+		}
+	}
+
+private:
+	const AnimatedModel*        model;
+	vector<BlendNode>           nodes;
+	vector<string>              parameterNames;
+	vector<float>               parameterDefaults;
+	vector<float>               parameterSmoothing;
+	vector<AnimationState>      states;
+	vector<AnimationTransition> transitions;
+
+	int addNode(const BlendNode& node)
+	{
+		nodes.push_back(node);
+		return (int)nodes.size() - 1;
+	}
+
+	// Un hot reload puede dejar el modelo con menos clips
+	bool isValidClip(unsigned int clip) const
+	{
+		return clip < model->skeleton.getClipCount() && model->getClipFrames(clip) > 1.0;
+	}
+
+	// Hijos vecinos al valor del parametro y el factor entre ellos
+	static float weights1D(const BlendNode& node, const float* parameters, int& first, int& second)
+	{
+		float value = parameters[node.parameterX];
+		int last = (int)node.children.size() - 1;
+		first = second = 0;
+		if (value <= node.positions[0].x) return 0.0f;
+		first = second = last;
+		if (value >= node.positions[last].x) return 0.0f;
+		for (int i = 0; i < last; i++) {
+			if (value < node.positions[i + 1].x) {
+				first = i;
+				second = i + 1;
+				return (value - node.positions[i].x) / (node.positions[i + 1].x - node.positions[i].x);
+			}
+		}
+		return 0.0f;
+	}
+
+	static glm::vec2 point2D(const BlendNode& node, const float* parameters)
+	{
+		return glm::vec2(parameters[node.parameterX], parameters[node.parameterY]);
+	}
+
+	// Suma de pesos sin normalizar (1 / distancia^2); negativa si el punto cae sobre un
+	// hijo, que entonces se lleva todo el peso
+	static float weightTotal2D(const BlendNode& node, const float* parameters)
+	{
+		glm::vec2 point = point2D(node, parameters);
+		float total = 0.0f;
+		for (const glm::vec2& position : node.positions) {
+			glm::vec2 offset = point - position;
+			float distance2 = glm::dot(offset, offset);
+			if (distance2 < 1e-8f) return -1.0f;
+			total += 1.0f / distance2;
+		}
+		return total;
+	}
+
+	static float weight2D(const BlendNode& node, const float* parameters, size_t child, float total)
+	{
+		glm::vec2 offset = point2D(node, parameters) - node.positions[child];
+		float distance2 = glm::dot(offset, offset);
+		if (total < 0.0f) {
+			// solo el primer hijo que coincide con el punto
+			for (size_t i = 0; i < child; i++) {
+				glm::vec2 other = point2D(node, parameters) - node.positions[i];
+				if (glm::dot(other, other) < 1e-8f) return 0.0f;
+			}
+			return distance2 < 1e-8f ? 1.0f : 0.0f;
+		}
+		return (1.0f / distance2) / total;
+	}
+};
+
+#endif
@@ -0,0 +1,394 @@
+#ifndef ASSETCOOKER_H
+#define ASSETCOOKER_H
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <assetpack.h>
+#include <cubemapcooker.h>
+#include <modelcache.h>
+#include <threadpool.h>
+
+// Cocinado por lotes sin ventana ni contexto GL: importa cada modelo con el mismo
+// pipeline del juego (Assimp, optimizacion, LODs, meshlets), comprime sus texturas
+// y escribe los artefactos junto a cada fuente. Lo usa la herramienta asset_cooker.
+
+#define COOK_MANIFEST_HEADER "# monster_house cooked assets v1"
+
+enum CookStatus {
+	COOK_STATUS_COOKED,     // se genero de nuevo
+	COOK_STATUS_UP_TO_DATE, // el artefacto ya correspondia al hash de la fuente
+	COOK_STATUS_FAILED
+};
+
+inline const char* cookStatusName(CookStatus status)
+{
+	switch (status) {
+	case COOK_STATUS_COOKED:     return "cooked";
+	case COOK_STATUS_UP_TO_DATE: return "up-to-date";
+	default:                     return "failed";
+	}
+}
+
+// Una entrada del manifiesto
+struct CookedAsset {
+	string     kind;   // "model", "texture" o "cubemap"
+	string     source;
+	string     cooked;
+	uint64_t   sourceHash = 0;
+	uint64_t   sourceBytes = 0;
+	uint64_t   cookedBytes = 0;
+	double     milliseconds = 0.0;
+	CookStatus status = COOK_STATUS_FAILED;
+};
+
+struct CookSettings {
+	string         root = "monster_house";
+	unsigned int   threads = 0;     // 0: los del ThreadPool por defecto
+	bool           force = false;   // ignorar artefactos vigentes
+	vector<string> mergeModels;     // nombres de archivo que se cocinan con mergeStaticMeshes
+};
+
+inline uint64_t fileSizeBytes(const string& path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	return file ? (uint64_t)file.tellg() : 0;
+}
+
+inline string lowercaseExtension(const string& path)
+{
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of('/');
+	if (dot == string::npos || (slash != string::npos && dot < slash)) return "";
+	string extension = path.substr(dot);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return extension;
+}
+
+// Archivos bajo un directorio (recursivo), con '/' como separador y en orden estable
+inline void listFilesRecursive(const string& directory, vector<string>& files)
+{
+	vector<string> subdirectories;
+#ifdef _WIN32
+	WIN32_FIND_DATAA entry;
+	HANDLE find = FindFirstFileA((directory + "/*").c_str(), &entry);
+	if (find == INVALID_HANDLE_VALUE) return;
+	do {
+		string name = entry.cFileName;
+		if (name == "." || name == "..") continue;
+		if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) subdirectories.push_back(directory + '/' + name);
+		else files.push_back(directory + '/' + name);
+	} while (FindNextFileA(find, &entry));
+	FindClose(find);
+#else
+	DIR* dir = opendir(directory.c_str());
+	if (!dir) return;
+	while (dirent* entry = readdir(dir)) {
+		string name = entry->d_name;
+		if (name == "." || name == "..") continue;
+		string path = directory + '/' + name;
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) continue;
+		if (S_ISDIR(info.st_mode)) subdirectories.push_back(path);
+		else files.push_back(path);
+	}
+	closedir(dir);
+#endif
+	std::sort(subdirectories.begin(), subdirectories.end());
+	for (const string& subdirectory : subdirectories)
+		listFilesRecursive(subdirectory, files);
+}
+
+inline bool isModelSource(const string& path)
+{
+	string extension = lowercaseExtension(path);
+	return extension == ".fbx" || extension == ".obj" || extension == ".dae" || extension == ".gltf" || extension == ".glb";
+}
+
+inline bool isTextureSource(const string& path)
+{
+	string extension = lowercaseExtension(path);
+	return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp";
+}
+
+inline double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Cocina un modelo y devuelve las texturas que referencian sus materiales (con su rol)
+inline CookedAsset cookModel(const string& path, const ImportOptions& options, bool force,
+	vector<std::pair<string, TextureRole>>& textures)
+{
+	auto start = std::chrono::steady_clock::now();
+	CookedAsset asset;
+	asset.kind = "model";
+	asset.source = path;
+	asset.cooked = modelCachePath(path, options);
+	asset.sourceHash = hashFile(path);
+	asset.sourceBytes = fileSizeBytes(path);
+	if (asset.sourceHash == 0) return asset;
+
+	ModelData data;
+	data.path = path;
+	data.directory = path.substr(0, path.find_last_of('/'));
+	if (!force && readModelCache(asset.cooked, asset.sourceHash, data)) {
+		asset.status = COOK_STATUS_UP_TO_DATE;
+	}
+	else {
+		Assimp::Importer importer;
+		if (!importModel(importer, path, data, options) || !writeModelCache(asset.cooked, asset.sourceHash, data)) {
+			asset.milliseconds = millisecondsSince(start);
+			return asset;
+		}
+		asset.status = COOK_STATUS_COOKED;
+	}
+
+	for (const MeshData& mesh : data.meshes)
+		for (const TextureRef& ref : mesh.textures)
+			if (!ref.solidColor)
+				textures.push_back(std::make_pair(data.directory + '/' + ref.path, textureRoleForType(ref.type)));
+
+	asset.cookedBytes = fileSizeBytes(asset.cooked);
+	asset.milliseconds = millisecondsSince(start);
+	return asset;
+}
+
+inline CookedAsset cookTexture(const string& path, TextureRole role, bool force)
+{
+	auto start = std::chrono::steady_clock::now();
+	CookedAsset asset;
+	asset.kind = "texture";
+	asset.source = path;
+	asset.cooked = cookedTexturePath(path, role);
+	asset.sourceHash = hashFile(path);
+	asset.sourceBytes = fileSizeBytes(path);
+	if (asset.sourceHash == 0) return asset;
+
+	CompressedImage image;
+	if (!force && readCookedTexture(asset.cooked, asset.sourceHash, image)) {
+		asset.status = COOK_STATUS_UP_TO_DATE;
+	}
+	else {
+		if (force) std::remove(asset.cooked.c_str());
+		if (!loadCookedTexture(path, role, asset.sourceHash, image)) {
+			asset.milliseconds = millisecondsSince(start);
+			return asset;
+		}
+		asset.status = COOK_STATUS_COOKED;
+	}
+
+	asset.cookedBytes = fileSizeBytes(asset.cooked);
+	asset.milliseconds = millisecondsSince(start);
+	return asset;
+}
+
+// Las seis caras se cocinan juntas en un solo DDS de cubemap
+inline CookedAsset cookCubemap(const vector<string>& faces, bool force)
+{
+	auto start = std::chrono::steady_clock::now();
+	CookedAsset asset;
+	asset.kind = "cubemap";
+	asset.source = faces[0];
+	asset.cooked = cookedCubemapPath(faces);
+	asset.sourceHash = cubemapSourceHash(faces, asset.cooked);
+	for (const string& face : faces)
+		asset.sourceBytes += fileSizeBytes(face);
+	if (asset.sourceHash == 0) return asset;
+
+	vector<CompressedImage> images;
+	if (!force && readCookedCubemap(asset.cooked, asset.sourceHash, images)) {
+		asset.status = COOK_STATUS_UP_TO_DATE;
+	}
+	else {
+		if (force) std::remove(asset.cooked.c_str());
+		if (!loadCookedCubemap(faces, images) || fileSizeBytes(asset.cooked) == 0) {
+			asset.milliseconds = millisecondsSince(start);
+			return asset;
+		}
+		asset.status = COOK_STATUS_COOKED;
+	}
+
+	asset.cookedBytes = fileSizeBytes(asset.cooked);
+	asset.milliseconds = millisecondsSince(start);
+	return asset;
+}
+
+// Directorios con px, nx, py, ny, pz y nz (misma extension) son cubemaps; las caras
+// quedan en el orden de GL_TEXTURE_CUBE_MAP_POSITIVE_X en adelante
+inline void findCubemaps(const vector<string>& textureFiles, vector<vector<string>>& cubemaps)
+{
+	const char* faceNames[CUBEMAP_FACE_COUNT] = { "px", "nx", "py", "ny", "pz", "nz" };
+	for (const string& path : textureFiles) {
+		size_t slash = path.find_last_of('/') + 1;
+		size_t extensionLength = lowercaseExtension(path).size();
+		if (path.size() - slash != 2 + extensionLength || path.compare(slash, 2, faceNames[0]) != 0) continue;
+
+		vector<string> faces;
+		for (const char* name : faceNames) {
+			string face = path.substr(0, slash) + name + path.substr(path.size() - extensionLength);
+			if (std::find(textureFiles.begin(), textureFiles.end(), face) == textureFiles.end()) break;
+			faces.push_back(face);
+		}
+		if (faces.size() == CUBEMAP_FACE_COUNT) cubemaps.push_back(faces);
+	}
+}
+
+inline bool writeCookManifest(const string& path, const vector<CookedAsset>& assets)
+{
+	std::ofstream file(path);
+	if (!file) return false;
+	file << COOK_MANIFEST_HEADER << '\n'
+		<< "# kind\tstatus\tsource\tcooked\tsource_hash\tsource_bytes\tcooked_bytes\tms\n";
+	for (const CookedAsset& asset : assets) {
+		char hash[17];
+		snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)asset.sourceHash);
+		file << asset.kind << '\t' << cookStatusName(asset.status) << '\t' << asset.source << '\t' << asset.cooked << '\t'
+			<< hash << '\t' << asset.sourceBytes << '\t' << asset.cookedBytes << '\t' << asset.milliseconds << '\n';
+	}
+	return (bool)file;
+}
+
+// Recorre <root>/models y <root>/textures y cocina todo en el pool. Primero los modelos
+// (sus materiales dicen que texturas son mapas de normales) y despues cada textura una
+// sola vez; las que ningun modelo usa se cocinan como color (UI...), salvo las caras
+// de cubemaps, que van juntas en un DDS de cubemap.
+inline vector<CookedAsset> cookAssets(const CookSettings& settings)
+{
+	vector<string> modelFiles, textureFiles;
+	listFilesRecursive(settings.root + "/models", modelFiles);
+	listFilesRecursive(settings.root + "/textures", textureFiles);
+	modelFiles.erase(std::remove_if(modelFiles.begin(), modelFiles.end(), [](const string& path) { return !isModelSource(path); }), modelFiles.end());
+	textureFiles.erase(std::remove_if(textureFiles.begin(), textureFiles.end(), [](const string& path) { return !isTextureSource(path); }), textureFiles.end());
+
+	ThreadPool pool(settings.threads);
+	vector<CookedAsset> assets;
+
+	typedef vector<std::pair<string, TextureRole>> TextureList;
+	vector<std::future<CookedAsset>> modelJobs;
+	vector<std::shared_ptr<TextureList>> modelTextures;
+	for (const string& path : modelFiles) {
+		string name = path.substr(path.find_last_of('/') + 1);
+		ImportOptions options;
+		options.mergeStaticMeshes = std::find(settings.mergeModels.begin(), settings.mergeModels.end(), name) != settings.mergeModels.end();
+		std::shared_ptr<TextureList> textures = std::make_shared<TextureList>();
+		modelTextures.push_back(textures);
+		bool force = settings.force;
+		modelJobs.push_back(pool.submit([path, options, force, textures] { return cookModel(path, options, force, *textures); }));
+	}
+
+	// texturas distintas por archivo cocinado, para que dos hilos no escriban el mismo
+	TextureList pending;
+	vector<string> cookedPaths;
+	auto addTexture = [&](const string& path, TextureRole role) {
+		string cooked = cookedTexturePath(path, role);
+		if (std::find(cookedPaths.begin(), cookedPaths.end(), cooked) != cookedPaths.end()) return;
+		cookedPaths.push_back(cooked);
+		pending.push_back(std::make_pair(path, role));
+	};
+	for (size_t i = 0; i < modelJobs.size(); i++) {
+		assets.push_back(modelJobs[i].get());
+		for (const std::pair<string, TextureRole>& texture : *modelTextures[i])
+			addTexture(texture.first, texture.second);
+	}
+	vector<vector<string>> cubemaps;
+	findCubemaps(textureFiles, cubemaps);
+	for (const string& path : textureFiles) {
+		bool referenced = false;
+		for (const std::pair<string, TextureRole>& texture : pending)
+			referenced = referenced || texture.first == path;
+		for (const vector<string>& faces : cubemaps)
+			referenced = referenced || std::find(faces.begin(), faces.end(), path) != faces.end();
+		if (!referenced) addTexture(path, TEXTURE_ROLE_COLOR);
+	}
+
+	vector<std::future<CookedAsset>> textureJobs;
+	for (const std::pair<string, TextureRole>& texture : pending) {
+		bool force = settings.force;
+		textureJobs.push_back(pool.submit([texture, force] { return cookTexture(texture.first, texture.second, force); }));
+	}
+	for (const vector<string>& faces : cubemaps) {
+		bool force = settings.force;
+		textureJobs.push_back(pool.submit([faces, force] { return cookCubemap(faces, force); }));
+	}
+	for (std::future<CookedAsset>& job : textureJobs)
+		assets.push_back(job.get());
+	return assets;
+}
+
+// Nombre de una entrada del pack: la ruta con que la pide el juego, que corre desde el
+// padre de root ("monster_house/models/..."), aunque root se haya dado como ruta absoluta
+inline string packEntryName(const string& root, const string& path)
+{
+	string base = root;
+	while (base.size() > 1 && (base.back() == '/' || base.back() == '\\')) base.pop_back();
+	if (path.compare(0, base.size(), base) != 0) return path;
+	size_t slash = base.find_last_of("/\\");
+	return (slash == string::npos ? base : base.substr(slash + 1)) + path.substr(base.size());
+}
+
+// Empaqueta los artefactos cocinados y los shaders de <root>/shaders. Las entradas se
+// nombran con la misma ruta que pide el juego, asi que el pack reemplaza a los sueltos.
+inline bool writeAssetPack(const string& root, const vector<CookedAsset>& assets, const string& packPath)
+{
+	auto start = std::chrono::steady_clock::now();
+	AssetPackWriter writer;
+	for (const CookedAsset& asset : assets)
+		if (asset.status != COOK_STATUS_FAILED)
+			writer.add(packEntryName(root, asset.cooked), asset.cooked, asset.kind == "model" ? PACK_ENTRY_MODEL : PACK_ENTRY_TEXTURE, asset.sourceHash);
+
+	vector<string> shaders;
+	listFilesRecursive(root + "/shaders", shaders);
+	for (const string& path : shaders)
+		writer.add(packEntryName(root, path), path, PACK_ENTRY_SHADER, hashFile(path));
+
+	size_t stored = 0, deduped = 0;
+	if (!writer.write(packPath, &stored, &deduped)) return false;
+	std::cout << "Pack: " << packPath << " | " << toMegabytes(stored) << " MB stored, "
+		<< toMegabytes(deduped) << " MB shared between identical entries | "
+		<< millisecondsSince(start) << " ms" << std::endl;
+	return true;
+}
+
+inline void printCookSummary(const vector<CookedAsset>& assets, double totalMilliseconds)
+{
+	size_t cooked = 0, upToDate = 0, failed = 0;
+	uint64_t sourceBytes = 0, cookedBytes = 0;
+	for (const CookedAsset& asset : assets) {
+		std::cout << cookStatusName(asset.status) << "\t" << asset.kind << "\t" << asset.source
+			<< " | " << asset.sourceBytes / 1024 << " KB -> " << asset.cookedBytes / 1024 << " KB"
+			<< " | " << asset.milliseconds << " ms" << std::endl;
+		if (asset.status == COOK_STATUS_COOKED) cooked++;
+		else if (asset.status == COOK_STATUS_UP_TO_DATE) upToDate++;
+		else failed++;
+		sourceBytes += asset.sourceBytes;
+		cookedBytes += asset.cookedBytes;
+	}
+	std::cout << "Assets: " << assets.size() << " (" << cooked << " cooked, " << upToDate << " up to date, "
+		<< failed << " failed) | source " << toMegabytes((size_t)sourceBytes) << " MB | cooked "
+		<< toMegabytes((size_t)cookedBytes) << " MB | " << totalMilliseconds << " ms" << std::endl;
+}
+
+#endif
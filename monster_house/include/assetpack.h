@@ -0,0 +1,306 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <mappedfile.h>
+
+// Pack de assets: un solo archivo con una tabla de contenidos y chunks alineados cuyo
+// contenido se identifica por hash. Cada entrada es un nombre logico (la ruta con la que
+// el juego pide el artefacto: "monster_house/models/piso.fbx.mhc", un .cooked.dds, un
+// shader...) que apunta a un chunk; dos entradas con el mismo contenido comparten chunk.
+// El pack se proyecta en memoria una vez y los lectores reciben vistas sobre esa
+// proyeccion, asi que los vertices y los bloques comprimidos van directo a GL.
+//
+// Formato: PackHeader | PackChunk[chunkCount] | PackEntry[entryCount] (ordenadas por
+// nombre) | nombres | chunks alineados a ASSET_PACK_ALIGNMENT.
+
+#define ASSET_PACK_MAGIC     0x4B50484Du // "MHPK"
+#define ASSET_PACK_VERSION   1u
+#define ASSET_PACK_EXTENSION ".mhp"
+#define ASSET_PACK_ALIGNMENT 256 // multiplo de MODEL_CACHE_ALIGNMENT y de una linea de cache
+
+// Con 1 el juego solo acepta artefactos ya cocinados (por asset_cooker) y nunca importa
+// ni comprime en tiempo de carga. Lo fija cada proyecto; la herramienta lo deja en 0.
+// viaje_lunar lo activa solo en Release|x64, que compila asset_cooker y lo corre antes.
+#ifndef COOKED_ASSETS_ONLY
+#define COOKED_ASSETS_ONLY 0
+#endif
+
+enum PackEntryKind : uint32_t {
+	PACK_ENTRY_MODEL,
+	PACK_ENTRY_TEXTURE,
+	PACK_ENTRY_SHADER,
+	PACK_ENTRY_OTHER
+};
+
+struct PackHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t chunkCount;
+	uint32_t entryCount;
+	uint64_t namesOffset;
+	uint64_t namesSize;
+};
+
+struct PackChunk {
+	uint64_t hash;   // FNV-1a del contenido
+	uint64_t offset; // desde el inicio del pack
+	uint64_t size;
+};
+
+struct PackEntry {
+	uint32_t nameOffset; // dentro de la tabla de nombres
+	uint32_t nameLength;
+	uint32_t chunk;
+	uint32_t kind;       // PackEntryKind
+	uint64_t sourceHash; // hash de la fuente con la que se cocino el artefacto
+};
+
+// Pack montado por el proceso. Se monta una vez al arrancar, antes de lanzar cargas en
+// segundo plano; despues solo se consulta, asi que se puede leer desde cualquier hilo.
+class AssetPack
+{
+public:
+	static AssetPack& instance()
+	{
+		static AssetPack pack;
+		return pack;
+	}
+
+	bool mount(const std::string& path)
+	{
+		unmount();
+		std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+		if (!mapping->open(path)) return false;
+
+		const unsigned char* base = mapping->data();
+		size_t size = mapping->getSize();
+		if (size < sizeof(PackHeader)) return false;
+		const PackHeader* packHeader = (const PackHeader*)base;
+		if (packHeader->magic != ASSET_PACK_MAGIC || packHeader->version != ASSET_PACK_VERSION) return false;
+
+		uint64_t tables = sizeof(PackHeader) + (uint64_t)packHeader->chunkCount * sizeof(PackChunk) +
+			(uint64_t)packHeader->entryCount * sizeof(PackEntry);
+		if (tables > size || packHeader->namesOffset < tables || packHeader->namesOffset + packHeader->namesSize > size)
+			return false;
+
+		const PackChunk* packChunks = (const PackChunk*)(base + sizeof(PackHeader));
+		const PackEntry* packEntries = (const PackEntry*)(packChunks + packHeader->chunkCount);
+		for (uint32_t i = 0; i < packHeader->chunkCount; i++)
+			if (packChunks[i].offset + packChunks[i].size > size) return false;
+		for (uint32_t i = 0; i < packHeader->entryCount; i++)
+			if (packEntries[i].chunk >= packHeader->chunkCount ||
+				(uint64_t)packEntries[i].nameOffset + packEntries[i].nameLength > packHeader->namesSize) return false;
+
+		file = mapping;
+		header = packHeader;
+		chunks = packChunks;
+		entries = packEntries;
+		names = (const char*)(base + packHeader->namesOffset);
+		std::cout << "Asset pack: " << path << " | " << header->entryCount << " entries, "
+			<< header->chunkCount << " chunks, " << size / 1024 << " KB" << std::endl;
+		return true;
+	}
+
+	void unmount()
+	{
+		file.reset();
+		header = nullptr;
+		chunks = nullptr;
+		entries = nullptr;
+		names = nullptr;
+	}
+
+	bool isMounted() const { return file != nullptr; }
+
+	// Busqueda binaria por nombre; nullptr si no esta en el pack
+	const PackEntry* find(const std::string& name) const
+	{
+		if (!file) return nullptr;
+		const PackEntry* first = entries;
+		const PackEntry* last = entries + header->entryCount;
+		const PackEntry* found = std::lower_bound(first, last, name, [this](const PackEntry& entry, const std::string& key) {
+			return compareName(entry, key) < 0;
+		});
+		return found != last && compareName(*found, name) == 0 ? found : nullptr;
+	}
+
+	// Vista sobre el chunk de una entrada; mantiene viva la proyeccion del pack
+	std::shared_ptr<MappedFile> open(const std::string& name) const
+	{
+		const PackEntry* entry = find(name);
+		if (!entry) return nullptr;
+		const PackChunk& chunk = chunks[entry->chunk];
+		std::shared_ptr<MappedFile> view = std::make_shared<MappedFile>();
+		if (!view->openView(file, (size_t)chunk.offset, (size_t)chunk.size)) return nullptr;
+		return view;
+	}
+
+	// Hash de la fuente registrado al empaquetar (0 si la entrada no existe)
+	uint64_t sourceHash(const std::string& name) const
+	{
+		const PackEntry* entry = find(name);
+		return entry ? entry->sourceHash : 0;
+	}
+
+private:
+	std::shared_ptr<MappedFile> file;
+	const PackHeader* header = nullptr;
+	const PackChunk* chunks = nullptr;
+	const PackEntry* entries = nullptr;
+	const char* names = nullptr;
+
+	AssetPack() {}
+
+	int compareName(const PackEntry& entry, const std::string& key) const
+	{
+		size_t length = std::min((size_t)entry.nameLength, key.size());
+		int result = std::memcmp(names + entry.nameOffset, key.data(), length);
+		if (result != 0) return result;
+		return entry.nameLength < key.size() ? -1 : (entry.nameLength > key.size() ? 1 : 0);
+	}
+};
+
+// Texto completo de una entrada del pack (shaders); false si no esta empaquetada
+inline bool readPackedText(const std::string& path, std::string& text)
+{
+	std::shared_ptr<MappedFile> file = AssetPack::instance().open(path);
+	if (!file) return false;
+	text.assign((const char*)file->data(), file->getSize());
+	return true;
+}
+
+// Arma un pack a partir de archivos ya cocinados. Los archivos se hashean y se
+// comparan byte a byte contra los chunks existentes antes de compartirlos.
+class AssetPackWriter
+{
+public:
+	void add(const std::string& name, const std::string& path, PackEntryKind kind, uint64_t sourceHash)
+	{
+		Pending entry;
+		entry.name = name;
+		entry.path = path;
+		entry.kind = kind;
+		entry.sourceHash = sourceHash;
+		pending.push_back(entry);
+	}
+
+	bool write(const std::string& packPath, size_t* storedBytes = nullptr, size_t* dedupedBytes = nullptr)
+	{
+		// nombres unicos y ordenados para la busqueda binaria
+		std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) { return a.name < b.name; });
+		pending.erase(std::unique(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) { return a.name == b.name; }), pending.end());
+
+		std::vector<PackChunk> chunks;
+		std::vector<std::string> chunkPaths;
+		std::vector<PackEntry> entries;
+		std::string names;
+		std::unordered_multimap<uint64_t, uint32_t> byHash;
+		size_t deduped = 0;
+
+		for (const Pending& item : pending) {
+			MappedFile source;
+			if (!source.open(item.path)) {
+				std::cout << "WARNING::ASSET_PACK:: could not read " << item.path << std::endl;
+				continue;
+			}
+			uint64_t hash = hashBytes(source.data(), source.getSize());
+
+			uint32_t chunk = (uint32_t)chunks.size();
+			auto range = byHash.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it) {
+				MappedFile other;
+				if (chunks[it->second].size == source.getSize() && other.open(chunkPaths[it->second]) &&
+					std::memcmp(other.data(), source.data(), source.getSize()) == 0) {
+					chunk = it->second;
+					deduped += source.getSize();
+					break;
+				}
+			}
+			if (chunk == chunks.size()) {
+				PackChunk record = {};
+				record.hash = hash;
+				record.size = source.getSize();
+				chunks.push_back(record);
+				chunkPaths.push_back(item.path);
+				byHash.insert(std::make_pair(hash, chunk));
+			}
+
+			PackEntry entry = {};
+			entry.nameOffset = (uint32_t)names.size();
+			entry.nameLength = (uint32_t)item.name.size();
+			entry.chunk = chunk;
+			entry.kind = item.kind;
+			entry.sourceHash = item.sourceHash;
+			entries.push_back(entry);
+			names += item.name;
+		}
+
+		PackHeader header = {};
+		header.magic = ASSET_PACK_MAGIC;
+		header.version = ASSET_PACK_VERSION;
+		header.chunkCount = (uint32_t)chunks.size();
+		header.entryCount = (uint32_t)entries.size();
+		header.namesOffset = sizeof(PackHeader) + chunks.size() * sizeof(PackChunk) + entries.size() * sizeof(PackEntry);
+		header.namesSize = names.size();
+
+		uint64_t offset = header.namesOffset + header.namesSize;
+		size_t stored = 0;
+		for (PackChunk& chunk : chunks) {
+			offset = (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+			chunk.offset = offset;
+			offset += chunk.size;
+			stored += (size_t)chunk.size;
+		}
+
+		std::string tempPath = packPath + ".tmp";
+		{
+			std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+			if (!out) return false;
+			out.write((const char*)&header, sizeof(header));
+			if (!chunks.empty()) out.write((const char*)chunks.data(), chunks.size() * sizeof(PackChunk));
+			if (!entries.empty()) out.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+			out.write(names.data(), names.size());
+
+			static const char zeros[ASSET_PACK_ALIGNMENT] = {};
+			uint64_t written = header.namesOffset + header.namesSize;
+			for (size_t i = 0; i < chunks.size(); i++) {
+				out.write(zeros, (std::streamsize)(chunks[i].offset - written));
+				MappedFile source;
+				if (!source.open(chunkPaths[i]) || source.getSize() != chunks[i].size) return false;
+				out.write((const char*)source.data(), source.getSize());
+				written = chunks[i].offset + chunks[i].size;
+			}
+			if (!out) return false;
+		}
+
+		// reemplazo al final para que un pack a medio escribir nunca quede montable
+		std::remove(packPath.c_str());
+		if (std::rename(tempPath.c_str(), packPath.c_str()) != 0) return false;
+		if (storedBytes) *storedBytes = stored;
+		if (dedupedBytes) *dedupedBytes = deduped;
+		return true;
+	}
+
+private:
+	struct Pending
+	{
+		std::string   name;
+		std::string   path;
+		PackEntryKind kind;
+		uint64_t      sourceHash;
+	};
+	std::vector<Pending> pending;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef BLOCKCOMPRESSION_H
+#define BLOCKCOMPRESSION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Compresion por bloques de 4x4 en CPU (BC1/BC3/BC4/BC5) para cocinar texturas.
+// Calidad de "cocinado rapido": extremos sobre el eje principal del bloque y
+// busqueda del indice mas cercano; suficiente para texturas de escenario.
+
+#define BC_BLOCK_PIXELS 16
+
+// Bloque de 4x4 RGBA8 extraido de la imagen (los bordes se repiten si no es multiplo de 4)
+inline void extractBlock(const unsigned char* rgba, int width, int height, int blockX, int blockY, unsigned char block[BC_BLOCK_PIXELS * 4])
+{
+	for (int y = 0; y < 4; y++) {
+		int sy = std::min(blockY * 4 + y, height - 1);
+		for (int x = 0; x < 4; x++) {
+			int sx = std::min(blockX * 4 + x, width - 1);
+			std::memcpy(&block[(y * 4 + x) * 4], &rgba[((size_t)sy * width + sx) * 4], 4);
+		}
+	}
+}
+
+inline uint16_t packRGB565(const float color[3])
+{
+	int r = (int)(std::min(std::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	int g = (int)(std::min(std::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+	int b = (int)(std::min(std::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void unpackRGB565(uint16_t packed, int color[3])
+{
+	int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// BC1: dos colores 565 y 2 bits por pixel. Se usa siempre el modo de 4 colores
+// (color0 > color1), valido tambien como bloque de color de BC3.
+inline void compressBlockBC1(const unsigned char block[BC_BLOCK_PIXELS * 4], unsigned char out[8])
+{
+	// media y covarianza del bloque
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++)
+		for (int c = 0; c < 3; c++) mean[c] += block[i * 4 + c];
+	for (int c = 0; c < 3; c++) mean[c] /= BC_BLOCK_PIXELS;
+
+	float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		float r = block[i * 4 + 0] - mean[0], g = block[i * 4 + 1] - mean[1], b = block[i * 4 + 2] - mean[2];
+		cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+		cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+	}
+
+	// eje principal por iteracion de potencias
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 4; iteration++) {
+		float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		float length = std::max(std::max(std::fabs(x), std::fabs(y)), std::fabs(z));
+		if (length <= 0.0f) break;
+		axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+	}
+
+	float minProjection = 1e30f, maxProjection = -1e30f;
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		float p = (block[i * 4 + 0] - mean[0]) * axis[0] + (block[i * 4 + 1] - mean[1]) * axis[1] + (block[i * 4 + 2] - mean[2]) * axis[2];
+		minProjection = std::min(minProjection, p);
+		maxProjection = std::max(maxProjection, p);
+	}
+	float axisLength2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+	if (axisLength2 > 0.0f) {
+		minProjection /= axisLength2;
+		maxProjection /= axisLength2;
+	}
+
+	float high[3], low[3];
+	for (int c = 0; c < 3; c++) {
+		high[c] = mean[c] + axis[c] * maxProjection;
+		low[c] = mean[c] + axis[c] * minProjection;
+	}
+	uint16_t color0 = packRGB565(high);
+	uint16_t color1 = packRGB565(low);
+	if (color0 < color1) std::swap(color0, color1);
+
+	uint32_t indices = 0;
+	if (color0 != color1) {
+		int palette[4][3];
+		unpackRGB565(color0, palette[0]);
+		unpackRGB565(color1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+			int best = 0, bestDistance = 1 << 30;
+			for (int p = 0; p < 4; p++) {
+				int dr = block[i * 4 + 0] - palette[p][0];
+				int dg = block[i * 4 + 1] - palette[p][1];
+				int db = block[i * 4 + 2] - palette[p][2];
+				int distance = dr * dr + dg * dg + db * db;
+				if (distance < bestDistance) { bestDistance = distance; best = p; }
+			}
+			indices |= (uint32_t)best << (i * 2);
+		}
+	}
+
+	out[0] = (unsigned char)(color0 & 0xFF); out[1] = (unsigned char)(color0 >> 8);
+	out[2] = (unsigned char)(color1 & 0xFF); out[3] = (unsigned char)(color1 >> 8);
+	for (int b = 0; b < 4; b++) out[4 + b] = (unsigned char)(indices >> (b * 8));
+}
+
+// BC4: un canal con dos extremos de 8 bits y 3 bits por pixel (modo de 8 valores)
+inline void compressBlockBC4(const unsigned char block[BC_BLOCK_PIXELS * 4], int channel, unsigned char out[8])
+{
+	int high = 0, low = 255;
+	for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+		high = std::max(high, (int)block[i * 4 + channel]);
+		low = std::min(low, (int)block[i * 4 + channel]);
+	}
+
+	uint64_t indices = 0;
+	if (high != low) {
+		int palette[8];
+		palette[0] = high;
+		palette[1] = low;
+		for (int p = 1; p < 7; p++)
+			palette[p + 1] = ((7 - p) * high + p * low) / 7;
+		for (int i = 0; i < BC_BLOCK_PIXELS; i++) {
+			int value = block[i * 4 + channel];
+			int best = 0, bestDistance = 256;
+			for (int p = 0; p < 8; p++) {
+				int distance = std::abs(value - palette[p]);
+				if (distance < bestDistance) { bestDistance = distance; best = p; }
+			}
+			indices |= (uint64_t)best << (i * 3);
+		}
+	}
+
+	out[0] = (unsigned char)high;
+	out[1] = (unsigned char)low;
+	for (int b = 0; b < 6; b++) out[2 + b] = (unsigned char)(indices >> (b * 8));
+}
+
+enum BlockFormat {
+	BLOCK_FORMAT_BC1 = 1, // RGB opaco, 8 bytes por bloque
+	BLOCK_FORMAT_BC3,     // RGBA, 16 bytes por bloque
+	BLOCK_FORMAT_BC4,     // un canal, 8 bytes por bloque
+	BLOCK_FORMAT_BC5      // dos canales (normales XY), 16 bytes por bloque
+};
+
+inline size_t blockBytes(BlockFormat format)
+{
+	return (format == BLOCK_FORMAT_BC1 || format == BLOCK_FORMAT_BC4) ? 8 : 16;
+}
+
+inline size_t compressedSize(BlockFormat format, int width, int height)
+{
+	return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * blockBytes(format);
+}
+
+// Comprime una imagen RGBA8 completa; out debe tener compressedSize() bytes
+inline void compressImage(const unsigned char* rgba, int width, int height, BlockFormat format, unsigned char* out)
+{
+	int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	unsigned char block[BC_BLOCK_PIXELS * 4];
+	for (int by = 0; by < blocksY; by++) {
+		for (int bx = 0; bx < blocksX; bx++) {
+			extractBlock(rgba, width, height, bx, by, block);
+			switch (format) {
+			case BLOCK_FORMAT_BC1:
+				compressBlockBC1(block, out);
+				break;
+			case BLOCK_FORMAT_BC3:
+				compressBlockBC4(block, 3, out);
+				compressBlockBC1(block, out + 8);
+				break;
+			case BLOCK_FORMAT_BC4:
+				compressBlockBC4(block, 0, out);
+				break;
+			case BLOCK_FORMAT_BC5:
+				compressBlockBC4(block, 0, out);
+				compressBlockBC4(block, 1, out + 8);
+				break;
+			}
+			out += blockBytes(format);
+		}
+	}
+}
+
+#endif
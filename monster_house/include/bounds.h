@@ -0,0 +1,104 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// Volumen envolvente: caja alineada a los ejes y esfera. La esfera no es la de la caja:
+// se ajusta a los vertices (radio = distancia maxima al centro de la caja), asi que en
+// meshes alargados o diagonales es bastante mas chica que la media diagonal.
+// POD: se guarda tal cual en el cache cocinado.
+struct Bounds {
+	glm::vec3 min;
+	glm::vec3 max;
+	glm::vec3 center;
+	float     radius; // < 0: vacio
+
+	static Bounds empty()
+	{
+		Bounds bounds;
+		bounds.min = glm::vec3(1e30f);
+		bounds.max = glm::vec3(-1e30f);
+		bounds.center = glm::vec3(0.0f);
+		bounds.radius = -1.0f;
+		return bounds;
+	}
+
+	bool isEmpty() const { return radius < 0.0f; }
+
+	// stride permite recorrer directamente arreglos de Vertex
+	static Bounds fromPoints(const glm::vec3* points, size_t count, size_t stride = sizeof(glm::vec3))
+	{
+		Bounds bounds = empty();
+		if (count == 0) return bounds;
+
+		const unsigned char* base = (const unsigned char*)points;
+		for (size_t i = 0; i < count; i++) {
+			const glm::vec3& p = *(const glm::vec3*)(base + i * stride);
+			bounds.min = glm::min(bounds.min, p);
+			bounds.max = glm::max(bounds.max, p);
+		}
+		bounds.center = (bounds.min + bounds.max) * 0.5f;
+		float radius2 = 0.0f;
+		for (size_t i = 0; i < count; i++) {
+			glm::vec3 d = *(const glm::vec3*)(base + i * stride) - bounds.center;
+			radius2 = std::max(radius2, glm::dot(d, d));
+		}
+		bounds.radius = std::sqrt(radius2);
+		return bounds;
+	}
+
+	// union de cajas; la esfera resultante envuelve a las dos esferas
+	void merge(const Bounds& other)
+	{
+		if (other.isEmpty()) return;
+		if (isEmpty()) {
+			*this = other;
+			return;
+		}
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+
+		glm::vec3 offset = other.center - center;
+		float distance = glm::length(offset);
+		if (distance + other.radius <= radius) return;
+		if (distance + radius <= other.radius) {
+			center = other.center;
+			radius = other.radius;
+			return;
+		}
+		float merged = (distance + radius + other.radius) * 0.5f;
+		center += offset * ((merged - radius) / distance);
+		radius = merged;
+	}
+
+	// Caja de la caja transformada (Arvo) y esfera con el centro transformado y el radio
+	// escalado por el mayor factor de escala de la matriz
+	Bounds transformed(const glm::mat4& matrix) const
+	{
+		if (isEmpty()) return *this;
+
+		Bounds result;
+		glm::vec3 translation(matrix[3]);
+		result.min = translation;
+		result.max = translation;
+		for (int column = 0; column < 3; column++) {
+			for (int row = 0; row < 3; row++) {
+				float a = matrix[column][row] * min[column];
+				float b = matrix[column][row] * max[column];
+				result.min[row] += std::min(a, b);
+				result.max[row] += std::max(a, b);
+			}
+		}
+
+		float scale = std::max(std::max(glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1]))),
+			glm::length(glm::vec3(matrix[2])));
+		result.center = glm::vec3(matrix * glm::vec4(center, 1.0f));
+		result.radius = radius * scale;
+		return result;
+	}
+};
+
+#endif
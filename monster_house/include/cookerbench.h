@@ -0,0 +1,176 @@
+#ifndef COOKERBENCH_H
+#define COOKERBENCH_H
+
+#include <modelimporter.h>
+#include <skeleton.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Mediciones de asset_cooker sobre datos sinteticos (sin archivos ni OpenGL), para
+// reproducir los numeros de las optimizaciones del importador. Cada fila es el mejor
+// de COOKER_BENCH_RUNS intentos.
+#define COOKER_BENCH_RUNS 5
+
+// Generador fijo para que cada corrida arme exactamente los mismos datos
+struct BenchRandom {
+	uint32_t state = 0x9E3779B9u;
+
+	uint32_t next()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+	float unit() { return (next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+// Mesh con numVertices vertices y weightsPerVertex influencias por vertice, repartidas
+// al azar entre numBones huesos (sin repetir hueso en un mismo vertice)
+inline aiMesh* makeSkinBenchMesh(unsigned int numVertices, unsigned int weightsPerVertex, unsigned int numBones)
+{
+	BenchRandom random;
+	vector<vector<aiVertexWeight>> boneWeights(numBones);
+	for (unsigned int v = 0; v < numVertices; v++) {
+		unsigned int first = random.next() % numBones;
+		for (unsigned int w = 0; w < weightsPerVertex && w < numBones; w++) {
+			aiVertexWeight weight;
+			weight.mVertexId = v;
+			weight.mWeight = 0.05f + random.unit();
+			boneWeights[(first + w * 7) % numBones].push_back(weight);
+		}
+	}
+
+	aiMesh* mesh = new aiMesh();
+	mesh->mNumVertices = numVertices;
+	mesh->mNumBones = numBones;
+	mesh->mBones = new aiBone*[numBones];
+	for (unsigned int b = 0; b < numBones; b++) {
+		aiBone* bone = new aiBone();
+		bone->mNumWeights = (unsigned int)boneWeights[b].size();
+		bone->mWeights = new aiVertexWeight[bone->mNumWeights > 0 ? bone->mNumWeights : 1];
+		std::copy(boneWeights[b].begin(), boneWeights[b].end(), bone->mWeights);
+		mesh->mBones[b] = bone;
+	}
+	return mesh;
+}
+
+// asset_cooker --bench-skin: gatherSkinWeights con cada vez mas vertices y pesos
+inline void benchSkinWeights()
+{
+	const unsigned int vertexCounts[] = { 1000, 10000, 100000, 1000000 };
+	const unsigned int weightCounts[] = { 1, 4, MAX_SKIN_INFLUENCES, 2 * MAX_SKIN_INFLUENCES };
+	const unsigned int numBones = 64;
+
+	std::cout << "gatherSkinWeights | " << numBones << " bones | best of " << COOKER_BENCH_RUNS << std::endl;
+	std::cout << "vertices\tweights/vertex\tweights\tms\tns/weight" << std::endl;
+	for (unsigned int numVertices : vertexCounts) {
+		for (unsigned int weightsPerVertex : weightCounts) {
+			aiMesh* mesh = makeSkinBenchMesh(numVertices, weightsPerVertex, numBones);
+			vector<Vertex> vertices(numVertices);
+			double best = 0.0;
+			size_t totalWeights = 0;
+			for (int run = 0; run < COOKER_BENCH_RUNS; run++) {
+				std::fill(vertices.begin(), vertices.end(), Vertex());
+				auto start = std::chrono::steady_clock::now();
+				totalWeights = gatherSkinWeights(mesh, vertices);
+				double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (run == 0 || milliseconds < best) best = milliseconds;
+			}
+			std::cout << numVertices << "\t" << weightsPerVertex << "\t" << totalWeights << "\t" << best << "\t"
+				<< (totalWeights > 0 ? best * 1e6 / totalWeights : 0.0) << std::endl;
+			delete mesh;
+		}
+	}
+}
+
+// Cadena de numNodes nodos (cada uno hijo del anterior), un hueso por nodo y un clip
+// de numKeys ticks con una clave de posicion y de rotacion por tick en cada nodo
+inline void makeKeyframeBenchSkeleton(unsigned int numNodes, unsigned int numKeys, CompiledSkeleton& skeleton)
+{
+	BenchRandom random;
+	vector<NodeData> nodes(numNodes);
+	vector<Bone> bones(numNodes);
+	vector<AnimationClip> clips(1);
+	clips[0].name = "bench";
+	clips[0].duration = numKeys - 1;
+	clips[0].ticksPerSecond = 30.0;
+	clips[0].channels.resize(numNodes);
+	for (unsigned int n = 0; n < numNodes; n++) {
+		nodes[n].name = "bench_" + std::to_string(n);
+		nodes[n].parent = (int)n - 1;
+		if (n + 1 < numNodes) nodes[n].children.push_back(n + 1);
+		bones[n].name.Set(nodes[n].name.c_str());
+
+		AnimationChannel& channel = clips[0].channels[n];
+		channel.nodeName = nodes[n].name;
+		channel.positionKeys.resize(numKeys);
+		channel.rotationKeys.resize(numKeys);
+		for (unsigned int k = 0; k < numKeys; k++) {
+			aiVectorKey& position = channel.positionKeys[k];
+			position.mTime = k;
+			position.mValue.x = random.unit();
+			position.mValue.y = 1.0f;
+			position.mValue.z = random.unit();
+
+			glm::vec4 q = glm::normalize(glm::vec4(random.unit(), random.unit(), random.unit(), 1.0f));
+			aiQuatKey& rotation = channel.rotationKeys[k];
+			rotation.mTime = k;
+			rotation.mValue.x = q.x;
+			rotation.mValue.y = q.y;
+			rotation.mValue.z = q.z;
+			rotation.mValue.w = q.w;
+		}
+	}
+	skeleton.compile(nodes, bones, clips);
+}
+
+// asset_cooker --bench-keys: CompiledSkeleton::evaluate sobre clips de cada vez mas
+// claves, reproduciendo en orden (el cursor acierta el segmento) y con saltos al azar
+// (busqueda binaria). En orden el costo por pose no deberia crecer con las claves.
+inline void benchKeyframes()
+{
+	const unsigned int keyCounts[] = { 200, 2000, 20000 };
+	const unsigned int numNodes = 32;
+	const unsigned int numSamples = 20000;
+	const glm::mat4 identity(1.0f);
+
+	std::cout << "CompiledSkeleton::evaluate | " << numNodes << " nodes | " << numSamples << " poses | best of "
+		<< COOKER_BENCH_RUNS << std::endl;
+	std::cout << "keys	playback	ms	us/pose" << std::endl;
+	vector<glm::mat4> boneTransforms(numNodes);
+	volatile float sink = 0.0f; // para que el compilador no descarte las poses
+	for (unsigned int numKeys : keyCounts) {
+		CompiledSkeleton skeleton;
+		makeKeyframeBenchSkeleton(numNodes, numKeys, skeleton);
+		float duration = (float)(numKeys - 1);
+
+		// en orden: varios cuadros por clave, dando la vuelta al final del clip
+		vector<float> sequential(numSamples), seeks(numSamples);
+		BenchRandom random;
+		for (unsigned int i = 0; i < numSamples; i++) {
+			sequential[i] = std::fmod(i * 0.25f, duration);
+			seeks[i] = random.unit() * duration;
+		}
+
+		const char* names[2] = { "sequential", "random" };
+		const vector<float>* times[2] = { &sequential, &seeks };
+		for (int mode = 0; mode < 2; mode++) {
+			double best = 0.0;
+			for (int run = 0; run < COOKER_BENCH_RUNS; run++) {
+				AnimationCursor cursor;
+				auto start = std::chrono::steady_clock::now();
+				for (float time : *times[mode])
+					skeleton.evaluate(0, time, identity, cursor, boneTransforms.data(), boneTransforms.size());
+				double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				if (run == 0 || milliseconds < best) best = milliseconds;
+				sink = sink + boneTransforms.back()[3][0];
+			}
+			std::cout << numKeys << "\t" << names[mode] << "\t" << best << "\t" << best * 1000.0 / numSamples << std::endl;
+		}
+	}
+}
+
+#endif
@@ -15,6 +15,8 @@
 #include <vector>
 #include <stdlib.h>
 #include <shader_m.h>
+#include <texturecooker.h>
+#include <cubemapcooker.h>
 
 using namespace std;
 
@@ -86,28 +88,35 @@ public:
 	}
 
     void loadCubemap(vector<std::string> faces)
+    {
+        vector<CompressedImage> images;
+        loadCookedCubemap(faces, images);
+        uploadCubemap(images);
+    }
+
+    // Sube caras ya cocinadas (cargadas en un hilo de trabajo); solo toca OpenGL.
+    // Las caras que no se pudieron cargar se omiten.
+    void uploadCubemap(const vector<CompressedImage>& images)
     {
         glGenTextures(1, &textureID);
         glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-        int width, height, nrChannels;
-        for (unsigned int i = 0; i < faces.size(); i++)
+        // los mips solo se usan si todas las caras traen la misma cadena
+        size_t levels = images.empty() ? 0 : images[0].levels.size();
+        for (unsigned int i = 0; i < images.size(); i++)
         {
-            unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-            if (data)
-            {
-                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                    0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
-                );
-                stbi_image_free(data);
-            }
-            else
-            {
-                std::cout << "Cubemap tex failed to load at path: " << faces[i] << std::endl;
-                stbi_image_free(data);
-            }
+            if (images[i].valid())
+                uploadCompressedLevels(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, images[i]);
+            if (images[i].levels.size() != levels)
+                levels = 0;
+        }
+        if (levels > 1) {
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, (GLint)levels - 1);
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+        else {
+            glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         }
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
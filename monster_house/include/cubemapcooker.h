@@ -0,0 +1,186 @@
+#ifndef CUBEMAPCOOKER_H
+#define CUBEMAPCOOKER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <assetpack.h>
+#include <mappedfile.h>
+#include <texturecooker.h>
+
+// ============================================================================
+// CUBEMAPS COCINADOS
+// Las seis caras se guardan en un solo DDS de cubemap (+X, -X, +Y, -Y, +Z, -Z, cada
+// una con su cadena de mips comprimida) junto a la primera cara. Cargarlo es una
+// sola proyeccion del archivo y seis subidas comprimidas, sin decodificar JPEG.
+// ============================================================================
+
+#define COOKED_CUBEMAP_EXTENSION ".cubemap" COOKED_TEXTURE_EXTENSION
+#define CUBEMAP_FACE_COUNT       6
+
+#define DDSCAPS2_CUBEMAP          0x200
+#define DDSCAPS2_CUBEMAP_ALLFACES 0xFC00
+
+inline std::string cookedCubemapPath(const std::vector<std::string>& faces)
+{
+	return faces.empty() ? std::string() : faces[0] + COOKED_CUBEMAP_EXTENSION;
+}
+
+// Hash de las seis fuentes encadenado, con las mismas reglas que cookedSourceHash()
+inline uint64_t cubemapSourceHash(const std::vector<std::string>& faces, const std::string& cookedPath)
+{
+	uint64_t packedHash = AssetPack::instance().sourceHash(cookedPath);
+	if (COOKED_ASSETS_ONLY && packedHash != 0) return packedHash;
+
+	uint64_t hash = 14695981039346656037ull;
+	for (const std::string& face : faces) {
+		uint64_t faceHash = hashFile(face);
+		if (faceHash == 0) return packedHash;
+		hash = hashBytes((const unsigned char*)&faceHash, sizeof(faceHash), hash);
+	}
+	return faces.empty() ? 0 : hash;
+}
+
+// Bytes de una cara con todos sus niveles
+inline size_t compressedImageBytes(const CompressedImage& image)
+{
+	return image.levels.empty() ? 0 : image.levels.back().offset + image.levels.back().size;
+}
+
+inline bool parseCookedCubemap(const std::shared_ptr<MappedFile>& file, uint64_t sourceHash, std::vector<CompressedImage>& faces)
+{
+	if (file->getSize() < 4 + sizeof(DDSHeader)) return false;
+
+	uint32_t magic;
+	std::memcpy(&magic, file->data(), 4);
+	const DDSHeader* header = (const DDSHeader*)(file->data() + 4);
+	if (magic != DDS_MAGIC || header->size != sizeof(DDSHeader)) return false;
+	if (header->reserved1[0] != COOKED_TEXTURE_TAG || header->reserved1[1] != COOKED_TEXTURE_VERSION) return false;
+	if ((header->caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES)) != (DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES)) return false;
+	uint64_t storedHash = (uint64_t)header->reserved1[2] | ((uint64_t)header->reserved1[3] << 32);
+	if (storedHash != sourceHash) return false;
+
+	BlockFormat format;
+	if (!formatForFourCC(header->pixelFormat.fourCC, format)) return false;
+
+	// todas las caras comparten tamano y cadena de mips
+	CompressedImage face;
+	face.format = format;
+	face.width = (int)header->width;
+	face.height = (int)header->height;
+	int width = face.width, height = face.height;
+	size_t faceBytes = 0;
+	for (uint32_t level = 0; level < std::max(header->mipMapCount, 1u); level++) {
+		CompressedLevel mip;
+		mip.width = width;
+		mip.height = height;
+		mip.offset = faceBytes;
+		mip.size = compressedSize(format, width, height);
+		faceBytes += mip.size;
+		face.levels.push_back(mip);
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	size_t dataOffset = 4 + sizeof(DDSHeader);
+	if (dataOffset + faceBytes * CUBEMAP_FACE_COUNT > file->getSize()) return false;
+
+	std::vector<CompressedImage> result(CUBEMAP_FACE_COUNT, face);
+	for (size_t i = 0; i < result.size(); i++) {
+		result[i].backing = file;
+		result[i].dataOffset = dataOffset + i * faceBytes;
+	}
+	faces = std::move(result);
+	return true;
+}
+
+// Primero la copia del pack montado; si quedo vieja respecto a las fuentes, la suelta en disco
+inline bool readCookedCubemap(const std::string& cookedPath, uint64_t sourceHash, std::vector<CompressedImage>& faces)
+{
+	std::shared_ptr<MappedFile> packed = AssetPack::instance().open(cookedPath);
+	if (packed && parseCookedCubemap(packed, sourceHash, faces)) return true;
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	return file->open(cookedPath) && parseCookedCubemap(file, sourceHash, faces);
+}
+
+// Solo se escribe si las seis caras cargaron y son compatibles (mismo formato y tamano)
+inline bool writeCookedCubemap(const std::string& cookedPath, uint64_t sourceHash, const std::vector<CompressedImage>& faces)
+{
+	if (faces.size() != CUBEMAP_FACE_COUNT || !faces[0].valid()) return false;
+	const CompressedImage& first = faces[0];
+	for (const CompressedImage& face : faces) {
+		if (!face.valid() || face.format != first.format || face.width != first.width ||
+			face.height != first.height || face.levels.size() != first.levels.size())
+			return false;
+	}
+
+	DDSHeader header = {};
+	header.size = sizeof(DDSHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.height = (uint32_t)first.height;
+	header.width = (uint32_t)first.width;
+	header.pitchOrLinearSize = (uint32_t)first.levels[0].size;
+	header.mipMapCount = (uint32_t)first.levels.size();
+	header.reserved1[0] = COOKED_TEXTURE_TAG;
+	header.reserved1[1] = COOKED_TEXTURE_VERSION;
+	header.reserved1[2] = (uint32_t)(sourceHash & 0xFFFFFFFFu);
+	header.reserved1[3] = (uint32_t)(sourceHash >> 32);
+	header.pixelFormat.size = sizeof(DDSPixelFormat);
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.pixelFormat.fourCC = fourCCForFormat(first.format);
+	header.caps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	header.caps2 = DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES;
+
+	// se escribe a un temporal y se renombra para no dejar archivos a medias
+	std::string tmpPath = uniqueTempPath(cookedPath);
+	bool written;
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+		uint32_t magic = DDS_MAGIC;
+		out.write((const char*)&magic, 4);
+		out.write((const char*)&header, sizeof(header));
+		for (const CompressedImage& face : faces)
+			out.write((const char*)face.bytes(), compressedImageBytes(face));
+		written = (bool)out;
+	}
+	if (written) {
+		std::remove(cookedPath.c_str());
+		written = std::rename(tmpPath.c_str(), cookedPath.c_str()) == 0;
+	}
+	if (!written) std::remove(tmpPath.c_str());
+	return written;
+}
+
+// Carga el cubemap cocinado o lo genera cara por cara en este hilo (CPU). El AssetLoader
+// hace lo mismo pero con una cara por hilo de trabajo.
+inline bool loadCookedCubemap(const std::vector<std::string>& faces, std::vector<CompressedImage>& images)
+{
+	images.assign(faces.size(), CompressedImage());
+	std::string cookedPath = cookedCubemapPath(faces);
+	uint64_t sourceHash = cubemapSourceHash(faces, cookedPath);
+	if (sourceHash != 0 && readCookedCubemap(cookedPath, sourceHash, images))
+		return true;
+#if COOKED_ASSETS_ONLY
+	std::cout << "ERROR::TEXTURE_COOKER:: missing or stale cooked cubemap " << cookedPath << std::endl;
+	return false;
+#else
+	bool loaded = true;
+	for (size_t i = 0; i < faces.size(); i++) {
+		int components;
+		if (!compressTextureFile(faces[i], TEXTURE_ROLE_COLOR, images[i], components)) {
+			std::cout << "Cubemap tex failed to load at path: " << faces[i] << std::endl;
+			loaded = false;
+		}
+	}
+	if (loaded && sourceHash != 0 && !writeCookedCubemap(cookedPath, sourceHash, images))
+		std::cout << "WARNING::TEXTURE_COOKER:: could not write " << cookedPath << std::endl;
+	return loaded;
+#endif
+}
+
+#endif
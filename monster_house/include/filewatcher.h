@@ -0,0 +1,212 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Tiempo sin eventos antes de reportar un archivo: los exportadores y editores suelen
+// escribir en varias pasadas (o truncar y reescribir), y no se quiere cocinar a medias
+#define FILE_WATCH_SETTLE_SECONDS 0.25
+
+// Vigila un arbol de directorios sin bloquear: inotify en Linux (un watch por
+// directorio, se agregan los subdirectorios nuevos) y ReadDirectoryChangesW con
+// E/S superpuesta en Windows. poll() se llama una vez por frame desde el hilo principal.
+class FileWatcher
+{
+public:
+	FileWatcher() {}
+
+	~FileWatcher()
+	{
+		stop();
+	}
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	bool start(const std::string& directory)
+	{
+		stop();
+		root = directory;
+#ifdef _WIN32
+		directoryHandle = CreateFileA(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+		if (directoryHandle == INVALID_HANDLE_VALUE) return false;
+		overlapped = OVERLAPPED();
+		overlapped.hEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+		if (!overlapped.hEvent || !requestChanges()) {
+			stop();
+			return false;
+		}
+#else
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd < 0) return false;
+		addDirectory(directory);
+		if (directories.empty()) {
+			stop();
+			return false;
+		}
+#endif
+		return true;
+	}
+
+	void stop()
+	{
+#ifdef _WIN32
+		if (directoryHandle != INVALID_HANDLE_VALUE) {
+			CancelIo(directoryHandle);
+			CloseHandle(directoryHandle);
+		}
+		if (overlapped.hEvent) CloseHandle(overlapped.hEvent);
+		directoryHandle = INVALID_HANDLE_VALUE;
+		overlapped = OVERLAPPED();
+#else
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+		directories.clear();
+#endif
+		pending.clear();
+	}
+
+	bool isRunning() const
+	{
+#ifdef _WIN32
+		return directoryHandle != INVALID_HANDLE_VALUE;
+#else
+		return fd >= 0;
+#endif
+	}
+
+	// Archivos modificados (rutas con '/' bajo el directorio vigilado) que ya llevan
+	// FILE_WATCH_SETTLE_SECONDS sin cambios. Nunca bloquea.
+	void poll(std::vector<std::string>& changed)
+	{
+		changed.clear();
+		if (!isRunning()) return;
+		readEvents();
+
+		Clock::time_point now = Clock::now();
+		for (auto it = pending.begin(); it != pending.end();) {
+			if (std::chrono::duration<double>(now - it->second).count() >= FILE_WATCH_SETTLE_SECONDS) {
+				changed.push_back(it->first);
+				it = pending.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	std::string root;
+	std::unordered_map<std::string, Clock::time_point> pending; // ruta -> ultimo evento
+#ifdef _WIN32
+	HANDLE directoryHandle = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped = OVERLAPPED();
+	DWORD buffer[16 * 1024]; // alineado a DWORD como pide ReadDirectoryChangesW
+
+	bool requestChanges()
+	{
+		return ReadDirectoryChangesW(directoryHandle, buffer, sizeof(buffer), TRUE,
+			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE,
+			NULL, &overlapped, NULL) != 0;
+	}
+
+	void readEvents()
+	{
+		DWORD bytes = 0;
+		if (!GetOverlappedResult(directoryHandle, &overlapped, &bytes, FALSE)) return; // sigue pendiente
+
+		// bytes == 0: el buffer se desbordo y se perdieron eventos; no hay forma de saber cuales
+		const unsigned char* cursor = (const unsigned char*)buffer;
+		while (bytes > 0) {
+			const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)cursor;
+			if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+				int wideLength = (int)(info->FileNameLength / sizeof(WCHAR));
+				int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, NULL, 0, NULL, NULL);
+				std::string name(length, '\0');
+				WideCharToMultiByte(CP_UTF8, 0, info->FileName, wideLength, &name[0], length, NULL, NULL);
+				for (char& c : name)
+					if (c == '\\') c = '/';
+				pending[root + '/' + name] = Clock::now();
+			}
+			if (info->NextEntryOffset == 0) break;
+			cursor += info->NextEntryOffset;
+		}
+
+		ResetEvent(overlapped.hEvent);
+		if (!requestChanges()) stop();
+	}
+#else
+	int fd = -1;
+	std::unordered_map<int, std::string> directories; // watch -> directorio
+
+	// reportFiles: directorio creado despues de arrancar; los archivos que se escribieron
+	// antes de agregar su watch no generaron eventos, asi que se reportan aqui
+	void addDirectory(const std::string& directory, bool reportFiles = false)
+	{
+		int watch = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (watch < 0) return;
+		directories[watch] = directory;
+
+		DIR* dir = opendir(directory.c_str());
+		if (!dir) return;
+		while (dirent* entry = readdir(dir)) {
+			std::string name = entry->d_name;
+			if (name == "." || name == "..") continue;
+			std::string path = directory + '/' + name;
+			struct stat info;
+			if (stat(path.c_str(), &info) != 0) continue;
+			if (S_ISDIR(info.st_mode)) addDirectory(path, reportFiles);
+			else if (reportFiles) pending[path] = Clock::now();
+		}
+		closedir(dir);
+	}
+
+	void readEvents()
+	{
+		alignas(inotify_event) char events[16 * 1024];
+		for (;;) {
+			ssize_t length = read(fd, events, sizeof(events));
+			if (length <= 0) return; // EAGAIN: no hay mas eventos
+
+			for (char* cursor = events; cursor < events + length;) {
+				const inotify_event* event = (const inotify_event*)cursor;
+				cursor += sizeof(inotify_event) + event->len;
+				auto directory = directories.find(event->wd);
+				if (directory == directories.end() || event->len == 0) continue;
+
+				std::string path = directory->second + '/' + event->name;
+				if (event->mask & IN_ISDIR) {
+					if (event->mask & (IN_CREATE | IN_MOVED_TO)) addDirectory(path, true);
+				}
+				else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+					// IN_CREATE solo interesa para directorios: el archivo llega con IN_CLOSE_WRITE
+					pending[path] = Clock::now();
+				}
+			}
+		}
+	}
+#endif
+};
+
+#endif
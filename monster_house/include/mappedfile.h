@@ -0,0 +1,181 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Archivo de solo lectura proyectado en memoria. Los datos quedan disponibles
+// mientras el objeto exista, sin copias intermedias a buffers propios.
+class MappedFile
+{
+public:
+	MappedFile() {}
+
+	explicit MappedFile(const std::string& path)
+	{
+		open(path);
+	}
+
+	~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path)
+	{
+		close();
+#ifdef _WIN32
+		fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+			close();
+			return false;
+		}
+		size = (size_t)fileSize.QuadPart;
+
+		mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mappingHandle == NULL) {
+			close();
+			return false;
+		}
+		bytes = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+		fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			close();
+			return false;
+		}
+		size = (size_t)st.st_size;
+
+		void* ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		bytes = (ptr == MAP_FAILED) ? nullptr : (const unsigned char*)ptr;
+#endif
+		if (bytes == nullptr) {
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	// Vista de solo lectura sobre una parte de otra proyeccion (un chunk del pack de
+	// assets). No proyecta nada propio: mantiene viva la proyeccion de origen.
+	bool openView(const std::shared_ptr<MappedFile>& source, size_t offset, size_t length)
+	{
+		close();
+		if (!source || !source->isOpen() || length == 0 || offset + length > source->getSize()) return false;
+		parent = source;
+		bytes = source->data() + offset;
+		size = length;
+		return true;
+	}
+
+	void close()
+	{
+		if (parent) {
+			parent.reset();
+			bytes = nullptr;
+			size = 0;
+			return;
+		}
+#ifdef _WIN32
+		if (bytes) UnmapViewOfFile(bytes);
+		if (mappingHandle) CloseHandle(mappingHandle);
+		if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+		mappingHandle = NULL;
+		fileHandle = INVALID_HANDLE_VALUE;
+#else
+		if (bytes) munmap((void*)bytes, size);
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+#endif
+		bytes = nullptr;
+		size = 0;
+	}
+
+	bool isOpen() const { return bytes != nullptr; }
+	const unsigned char* data() const { return bytes; }
+	size_t getSize() const { return size; }
+
+private:
+	const unsigned char* bytes = nullptr;
+	size_t size = 0;
+	std::shared_ptr<MappedFile> parent; // solo en vistas
+#ifdef _WIN32
+	HANDLE fileHandle = INVALID_HANDLE_VALUE;
+	HANDLE mappingHandle = NULL;
+#else
+	int fd = -1;
+#endif
+};
+
+// Lee una pagina de cada 4 KB para que el sistema operativo traiga el rango a memoria.
+// Se llama desde hilos de trabajo antes de subir datos proyectados, asi el fallo de
+// pagina (la E/S real) no ocurre en el hilo GL. Devuelve un valor para que no se descarte.
+inline unsigned int prefetchBytes(const void* data, size_t length)
+{
+	const volatile unsigned char* bytes = (const volatile unsigned char*)data;
+	unsigned int sum = 0;
+	for (size_t offset = 0; offset < length; offset += 4096)
+		sum += bytes[offset];
+	if (length > 0) sum += bytes[length - 1];
+	return sum;
+}
+
+// Hash FNV-1a de 64 bits; se usa para invalidar datos cocinados cuando cambia el archivo fuente
+inline uint64_t hashBytes(const unsigned char* data, size_t length, uint64_t hash = 14695981039346656037ull)
+{
+	for (size_t i = 0; i < length; i++) {
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Temporal propio de quien escribe path (proceso y llamada): dos hilos o procesos que
+// cocinan el mismo artefacto no escriben el mismo archivo antes del rename
+inline std::string uniqueTempPath(const std::string& path)
+{
+	static std::atomic<unsigned int> counter(0);
+#ifdef _WIN32
+	unsigned long process = (unsigned long)GetCurrentProcessId();
+#else
+	unsigned long process = (unsigned long)getpid();
+#endif
+	return path + "." + std::to_string(process) + "." + std::to_string(counter++) + ".tmp";
+}
+
+// Hash del contenido completo de un archivo (0 si no se pudo abrir)
+inline uint64_t hashFile(const std::string& path)
+{
+	MappedFile file;
+	if (!file.open(path)) return 0;
+	return hashBytes(file.data(), file.getSize());
+}
+
+#endif
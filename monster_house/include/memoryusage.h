@@ -0,0 +1,22 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+inline double toMegabytes(size_t bytes)
+{
+	return bytes / (1024.0 * 1024.0);
+}
+
+// Reporte de una carga: lo que ocupaba la escena de Assimp (0 si vino del cache
+// cocinado) y lo que el modelo conserva en CPU una vez liberada
+inline void printModelMemoryReport(const std::string& path, size_t sceneBytes, size_t runtimeBytes)
+{
+	std::cout << "Model memory: " << path
+		<< " | assimp scene " << toMegabytes(sceneBytes) << " MB"
+		<< " | runtime data " << runtimeBytes / 1024 << " KB" << std::endl;
+}
+
+#endif
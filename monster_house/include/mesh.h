@@ -5,14 +5,22 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <shader.h>
+#include <meshletculling.h>
+#include <bounds.h>
+#include <textureresource.h>
 
+#include <algorithm>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <cstring>
+#include <unordered_map>
 using namespace std;
 
 // Bones information
@@ -38,78 +46,439 @@ struct Vertex {
 	glm::vec4 Weights3;
 };
 
+// Formatos compactos para la GPU. Vertex es solo el formato de importacion: se empaqueta
+// una vez al cocinar y el cache guarda ya estos formatos. Todos los atributos siguen
+// llegando al shader como float (normalizados o convertidos por el hardware), asi que
+// los mismos shaders funcionan con ambos formatos.
+
+// Mallas sin huesos: 28 bytes en vez de 152
+struct StaticVertex {
+    glm::vec3 Position;      // loc 0
+    uint32_t  Normal;        // loc 1, snorm 10:10:10:2
+    uint32_t  TexCoords;     // loc 2, half2
+    uint32_t  Tangent;       // loc 3, snorm 10:10:10:2
+    uint32_t  Bitangent;     // loc 4, snorm 10:10:10:2
+};
+
+// Mallas con huesos: 52 bytes; hasta MAX_NUM_BONES * 3 influencias
+struct SkinnedVertex {
+    StaticVertex Base;
+    uint8_t BoneIDs[3 * MAX_NUM_BONES];  // loc 5..7, enteros sin normalizar
+    uint8_t Weights[3 * MAX_NUM_BONES];  // loc 8..10, unorm8
+};
+
+static_assert(sizeof(StaticVertex) == 28, "StaticVertex debe quedar sin relleno");
+static_assert(sizeof(SkinnedVertex) == 52, "SkinnedVertex debe quedar sin relleno");
+
+inline uint32_t packDirection(const glm::vec3& v)
+{
+    float length = glm::length(v);
+    glm::vec3 n = length > 0.0f ? v / length : v;
+    return glm::packSnorm3x10_1x2(glm::vec4(n, 0.0f));
+}
+
+inline void packStaticVertex(const Vertex& in, StaticVertex& out)
+{
+    out.Position = in.Position;
+    out.Normal = packDirection(in.Normal);
+    out.TexCoords = glm::packHalf2x16(in.TexCoords);
+    out.Tangent = packDirection(in.Tangent);
+    out.Bitangent = packDirection(in.Bitangent);
+}
+
+inline void packSkinnedVertex(const Vertex& in, SkinnedVertex& out)
+{
+    packStaticVertex(in, out.Base);
+
+    const glm::vec4* ids[3] = { &in.IDs1, &in.IDs2, &in.IDs3 };
+    const glm::vec4* weights[3] = { &in.Weights1, &in.Weights2, &in.Weights3 };
+    int total = 0, largest = 0;
+    for (int s = 0; s < 3 * MAX_NUM_BONES; s++) {
+        float id = (*ids[s / MAX_NUM_BONES])[s % MAX_NUM_BONES];
+        float weight = (*weights[s / MAX_NUM_BONES])[s % MAX_NUM_BONES];
+        out.BoneIDs[s] = (uint8_t)glm::clamp(id, 0.0f, 255.0f);
+        out.Weights[s] = (uint8_t)(glm::clamp(weight, 0.0f, 1.0f) * 255.0f + 0.5f);
+        total += out.Weights[s];
+        if (out.Weights[s] > out.Weights[largest]) largest = s;
+    }
+    // el redondeo puede desviar la suma; se corrige en la influencia mayor para que sume 1
+    if (total > 0)
+        out.Weights[largest] = (uint8_t)glm::clamp(out.Weights[largest] + 255 - total, 0, 255);
+}
+
+// Un mesh usa el formato con huesos solo si algun vertice tiene peso
+inline bool hasSkinWeights(const Vertex* vertices, size_t numVertices)
+{
+    for (size_t i = 0; i < numVertices; i++) {
+        const Vertex& v = vertices[i];
+        if (v.Weights1 != glm::vec4(0.0f) || v.Weights2 != glm::vec4(0.0f) || v.Weights3 != glm::vec4(0.0f))
+            return true;
+    }
+    return false;
+}
+
+// Mallas con menos de 65536 vertices se suben con indices de 16 bits
+inline bool useShortIndices(size_t vertexCount)
+{
+    return vertexCount < 65536;
+}
+
+inline void packVertices(const Vertex* vertices, size_t count, bool skinned, vector<unsigned char>& out)
+{
+    if (skinned) {
+        out.resize(count * sizeof(SkinnedVertex));
+        SkinnedVertex* packed = (SkinnedVertex*)out.data();
+        for (size_t i = 0; i < count; i++)
+            packSkinnedVertex(vertices[i], packed[i]);
+    }
+    else {
+        out.resize(count * sizeof(StaticVertex));
+        StaticVertex* packed = (StaticVertex*)out.data();
+        for (size_t i = 0; i < count; i++)
+            packStaticVertex(vertices[i], packed[i]);
+    }
+}
+
+// numVertices decide el ancho (ver useShortIndices)
+inline void packIndices(const unsigned int* indices, size_t count, size_t numVertices, vector<unsigned char>& out)
+{
+    if (useShortIndices(numVertices)) {
+        out.resize(count * sizeof(unsigned short));
+        unsigned short* packed = (unsigned short*)out.data();
+        for (size_t i = 0; i < count; i++)
+            packed[i] = (unsigned short)indices[i];
+    }
+    else {
+        out.resize(count * sizeof(unsigned int));
+        std::memcpy(out.data(), indices, out.size());
+    }
+}
+
+// Geometria en el formato de la GPU: StaticVertex o SkinnedVertex, e indices de 16 o 32
+// bits segun useShortIndices(numVertices). Solo apunta a los datos (del importador, de un
+// proxy o de la proyeccion del cache), que se suben tal cual con glBufferData.
+struct MeshGeometry {
+    const unsigned char* vertices = nullptr;
+    size_t numVertices = 0;
+    const unsigned char* indices = nullptr;
+    size_t numIndices = 0;
+    bool skinned = false;
+
+    size_t vertexStride() const { return skinned ? sizeof(SkinnedVertex) : sizeof(StaticVertex); }
+    size_t indexSize() const { return useShortIndices(numVertices) ? sizeof(unsigned short) : sizeof(unsigned int); }
+    GLenum indexType() const { return useShortIndices(numVertices) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
+    size_t vertexBytes() const { return numVertices * vertexStride(); }
+    size_t indexBytes() const { return numIndices * indexSize(); }
+
+    // la posicion es el primer campo de ambos formatos
+    glm::vec3 position(size_t vertex) const
+    {
+        glm::vec3 p;
+        std::memcpy(&p, vertices + vertex * vertexStride(), sizeof(p));
+        return p;
+    }
+
+    unsigned int index(size_t i) const
+    {
+        if (useShortIndices(numVertices)) {
+            unsigned short value;
+            std::memcpy(&value, indices + i * sizeof(value), sizeof(value));
+            return value;
+        }
+        unsigned int value;
+        std::memcpy(&value, indices + i * sizeof(value), sizeof(value));
+        return value;
+    }
+};
+
+// Rango de un mesh original dentro de un mesh combinado por material
+struct SubMeshRange {
+    uint32_t firstIndex;
+    uint32_t numIndices;
+    uint32_t firstVertex;
+    uint32_t numVertices;
+};
+
+// Rango de indices de un nivel de detalle dentro del index buffer del mesh.
+// error: desviacion maxima respecto del nivel 0, en unidades del mesh.
+struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t numIndices;
+    float    error;
+    uint32_t padding;
+};
+
+// Textura de 1x1 por color (RGBA8) compartida por todo el proceso. Solo se crea si un mesh
+// de color constante se dibuja con un programa sin uniform hasDiffuseMap (solo hilo GL).
+inline unsigned int solidColorTexture(const glm::vec3& color)
+{
+    static unordered_map<uint32_t, unsigned int> textures;
+    unsigned char rgba[4] = {
+        (unsigned char)(glm::clamp(color.r, 0.0f, 1.0f) * 255.0f),
+        (unsigned char)(glm::clamp(color.g, 0.0f, 1.0f) * 255.0f),
+        (unsigned char)(glm::clamp(color.b, 0.0f, 1.0f) * 255.0f),
+        255
+    };
+    uint32_t key;
+    std::memcpy(&key, rgba, sizeof(key));
+    auto found = textures.find(key);
+    if (found != textures.end()) return found->second;
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    textures[key] = textureID;
+    return textureID;
+}
+
+// Samplers texture_<tipo>N por tipo que puede usar un mesh
+#define MESH_SAMPLERS_PER_TYPE 4
+
+enum MeshTextureSlot
+{
+    MESH_TEXTURE_DIFFUSE,
+    MESH_TEXTURE_SPECULAR,
+    MESH_TEXTURE_NORMAL,
+    MESH_TEXTURE_HEIGHT,
+    MESH_TEXTURE_SLOT_COUNT
+};
+
+inline int meshTextureSlot(const string& type)
+{
+    if (type == "texture_diffuse") return MESH_TEXTURE_DIFFUSE;
+    if (type == "texture_specular") return MESH_TEXTURE_SPECULAR;
+    if (type == "texture_normal") return MESH_TEXTURE_NORMAL;
+    if (type == "texture_height") return MESH_TEXTURE_HEIGHT;
+    return -1;
+}
+
+// Uniforms de material de un programa (-1 si no los declara): texture_<tipo>1..N y el
+// color constante (hasDiffuseMap, MeshBaseColor) de los materiales sin mapa difuso
+struct MeshUniformLocations
+{
+    GLint location[MESH_TEXTURE_SLOT_COUNT][MESH_SAMPLERS_PER_TYPE];
+    GLint hasDiffuseMap;
+    GLint baseColor;
+};
+
+inline unordered_map<unsigned int, MeshUniformLocations>& meshUniformCache()
+{
+    static unordered_map<unsigned int, MeshUniformLocations> cache;
+    return cache;
+}
+
+// Se piden a GL una sola vez por programa, la primera vez que dibuja un mesh (solo hilo GL)
+inline const MeshUniformLocations& meshUniformLocations(unsigned int program)
+{
+    unordered_map<unsigned int, MeshUniformLocations>& cache = meshUniformCache();
+    auto found = cache.find(program);
+    if (found != cache.end()) return found->second;
+
+    static const char* names[MESH_TEXTURE_SLOT_COUNT] = { "texture_diffuse", "texture_specular", "texture_normal", "texture_height" };
+    MeshUniformLocations& locations = cache[program];
+    for (int slot = 0; slot < MESH_TEXTURE_SLOT_COUNT; slot++)
+        for (int n = 0; n < MESH_SAMPLERS_PER_TYPE; n++)
+            locations.location[slot][n] = glGetUniformLocation(program, (names[slot] + std::to_string(n + 1)).c_str());
+    locations.hasDiffuseMap = glGetUniformLocation(program, "hasDiffuseMap");
+    locations.baseColor = glGetUniformLocation(program, "MeshBaseColor");
+    return locations;
+}
+
+// Al borrar un programa (recarga de shaders): GL puede reutilizar su ID para otro
+inline void forgetMeshUniformLocations(unsigned int program)
+{
+    meshUniformCache().erase(program);
+}
+
 struct Texture {
     unsigned int id;
     string type;
     string path;
+    std::shared_ptr<TextureResource> handle; // mantiene viva la textura compartida del TextureRegistry
 };
 
 class Mesh {
 public:
     /*  Mesh Data  */
-    vector<Vertex> vertices;
-    vector<unsigned int> indices;
+    // los vertices/indices solo viven en la GPU; la copia de CPU se suelta al subirlos
     vector<Texture> textures;
+    vector<SubMeshRange> submeshes; // partes originales si el mesh fue combinado por material
+    vector<MeshLod> lods;           // niveles de detalle; vacio si solo existe el original
+    vector<Meshlet> meshlets;       // grupos de triangulos del nivel 0 (solo meshes estaticos)
+    Bounds bounds = Bounds::empty(); // en espacio del mesh; en meshes con huesos es la pose de reposo
     unsigned int VAO;
+    unsigned int numIndices;        // indices del nivel 0
+    GLenum indexType;   // GL_UNSIGNED_SHORT si el mesh tiene menos de 65536 vertices
+    bool skinned;
+    unsigned int residentLod = 0;   // > 0: proxy de carga progresiva con solo ese LOD en la GPU
+    // material sin mapa difuso: el color va como constante (uniforms hasDiffuseMap = false y
+    // MeshBaseColor) y el shader no muestrea texture_diffuse1. Con programas que no declaran
+    // hasDiffuseMap se usa una textura de 1x1 de ese color (solidColorTexture).
+    bool hasSolidColor = false;
+    glm::vec3 solidColor = glm::vec3(1.0f);
 
     /*  Functions  */
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    // constructor: sube los datos directamente desde memoria externa (datos importados o
+    // un cache proyectado) sin guardar copia. Los indices traen el nivel 0 seguido de los LODs.
+    Mesh(const MeshGeometry& geometry, vector<Texture> textures,
+        vector<SubMeshRange> submeshes = vector<SubMeshRange>(), vector<MeshLod> lods = vector<MeshLod>(),
+        vector<Meshlet> meshlets = vector<Meshlet>())
     {
-        this->vertices = vertices;
-        this->indices = indices;
         this->textures = textures;
+        this->submeshes = submeshes;
+        this->lods = lods;
+        this->meshlets = meshlets;
+        setupMesh(geometry);
+        if (!this->lods.empty())
+            this->numIndices = this->lods[0].numIndices;
+    }
 
-        // now that we have all the required data, set the vertex buffers and its attribute pointers.
-        setupMesh();
+    // libera los buffers de GPU (solo hilo GL). Mesh se copia dentro de vectores, por eso
+    // no lo hace un destructor: lo llama quien reemplaza el modelo completo.
+    void release()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = VBO = EBO = 0;
     }
 
+    unsigned int getLodCount() const { return lods.empty() ? 1 : (unsigned int)lods.size(); }
+    float getLodError(unsigned int lod) const { return lods.empty() ? 0.0f : lods[std::min<size_t>(lod, lods.size() - 1)].error; }
+
     // render the mesh
     void Draw(Shader shader) 
     {
-        // bind appropriate textures
-        unsigned int diffuseNr  = 1;
-        unsigned int specularNr = 1;
-        unsigned int normalNr   = 1;
-        unsigned int heightNr   = 1;
-        for(unsigned int i = 0; i < textures.size(); i++)
-        {
-            glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
-            // retrieve texture number (the N in diffuse_textureN)
-            string number;
-            string name = textures[i].type;
-            if(name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if(name == "texture_specular")
-                number = std::to_string(specularNr++); // transfer unsigned int to stream
-            else if(name == "texture_normal")
-                number = std::to_string(normalNr++); // transfer unsigned int to stream
-             else if(name == "texture_height")
-                number = std::to_string(heightNr++); // transfer unsigned int to stream
-
-            // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
-            // and finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
-        }
-        
+        bindTextures(shader);
+
         // draw mesh
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, (GLsizei)numIndices, indexType, 0);
         glBindVertexArray(0);
 
         // always good practice to set everything back to defaults once configured.
         glActiveTexture(GL_TEXTURE0);
     }
 
+    // dibuja un nivel de detalle; si el mesh tiene menos niveles se usa el ultimo.
+    // Con culler, el nivel 0 solo envia los meshlets visibles.
+    void Draw(Shader shader, unsigned int lod, const MeshletCuller* culler = nullptr)
+    {
+        if (lod == 0 && culler && !meshlets.empty()) {
+            DrawMeshlets(shader, *culler);
+            return;
+        }
+        if (lods.empty() || lod == 0) {
+            Draw(shader);
+            return;
+        }
+        const MeshLod& range = lods[std::min<size_t>(lod, lods.size() - 1)];
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+
+        bindTextures(shader);
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, (GLsizei)range.numIndices, indexType, (void*)(range.firstIndex * indexSize));
+        glBindVertexArray(0);
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // dibuja solo las partes visibles de un mesh combinado (indices dentro de submeshes)
+    void Draw(Shader shader, const vector<unsigned int>& visibleSubmeshes)
+    {
+        if (visibleSubmeshes.empty()) return;
+        bindTextures(shader);
+
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+        glBindVertexArray(VAO);
+        for (unsigned int s : visibleSubmeshes) {
+            const SubMeshRange& range = submeshes[s];
+            glDrawElements(GL_TRIANGLES, (GLsizei)range.numIndices, indexType, (void*)(range.firstIndex * indexSize));
+        }
+        glBindVertexArray(0);
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
 private:
     /*  Render data  */
     unsigned int VBO, EBO;
 
+    // rangos visibles del frame; se reutilizan para no reservar memoria en cada draw
+    vector<GLsizei> drawCounts;
+    vector<const void*> drawOffsets;
+
+    void DrawMeshlets(Shader& shader, const MeshletCuller& culler)
+    {
+        size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+        drawCounts.clear();
+        drawOffsets.clear();
+        uint32_t rangeEnd = 0;
+        for (const Meshlet& meshlet : meshlets) {
+            if (!culler.isVisible(meshlet)) continue;
+            // meshlets vecinos en el index buffer se juntan en un solo rango
+            if (!drawCounts.empty() && meshlet.firstIndex == rangeEnd)
+                drawCounts.back() += (GLsizei)meshlet.numIndices;
+            else {
+                drawCounts.push_back((GLsizei)meshlet.numIndices);
+                drawOffsets.push_back((const void*)(meshlet.firstIndex * indexSize));
+            }
+            rangeEnd = meshlet.firstIndex + meshlet.numIndices;
+        }
+        if (drawCounts.empty()) return;
+
+        bindTextures(shader);
+        glBindVertexArray(VAO);
+        glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), indexType, drawOffsets.data(), (GLsizei)drawCounts.size());
+        glBindVertexArray(0);
+
+        glActiveTexture(GL_TEXTURE0);
+    }
+
     /*  Functions    */
+    void bindTextures(Shader& shader)
+    {
+        // bind appropriate textures
+        const MeshUniformLocations& uniforms = meshUniformLocations(shader.ID);
+        unsigned int count[MESH_TEXTURE_SLOT_COUNT] = {};
+        for(unsigned int i = 0; i < textures.size(); i++)
+        {
+            glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
+            // now set the sampler (texture_<type>N) to the correct texture unit
+            int slot = meshTextureSlot(textures[i].type);
+            if (slot >= 0 && count[slot] < MESH_SAMPLERS_PER_TYPE)
+                glUniform1i(uniforms.location[slot][count[slot]++], i);
+            // and finally bind the texture (the shared handle may have been hot-reloaded)
+            glBindTexture(GL_TEXTURE_2D, textures[i].handle ? textures[i].handle->id : textures[i].id);
+        }
+
+        // color constante: los programas con hasDiffuseMap lo leen de MeshBaseColor; a los
+        // que no lo declaran se les da una textura de 1x1 de ese color como texture_diffuseN
+        if (uniforms.hasDiffuseMap >= 0) {
+            glUniform1i(uniforms.hasDiffuseMap, hasSolidColor ? 0 : 1);
+            if (hasSolidColor)
+                glUniform3fv(uniforms.baseColor, 1, &solidColor[0]);
+        }
+        else if (hasSolidColor) {
+            unsigned int unit = (unsigned int)textures.size();
+            glActiveTexture(GL_TEXTURE0 + unit);
+            if (count[MESH_TEXTURE_DIFFUSE] < MESH_SAMPLERS_PER_TYPE)
+                glUniform1i(uniforms.location[MESH_TEXTURE_DIFFUSE][count[MESH_TEXTURE_DIFFUSE]], unit);
+            glBindTexture(GL_TEXTURE_2D, solidColorTexture(solidColor));
+        }
+    }
+
     // initializes all the buffer objects/arrays
-    void setupMesh()
+    void setupMesh(const MeshGeometry& geometry)
     {
+        this->numIndices = (unsigned int)geometry.numIndices;
+        this->skinned = geometry.skinned;
+        this->indexType = geometry.indexType();
 
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
@@ -117,51 +486,62 @@ private:
         glGenBuffers(1, &EBO);
 
         glBindVertexArray(VAO);
-        // load data into vertex buffers
+        // load data into vertex buffers (already in the compact layout of the mesh)
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        // A great thing about structs is that their memory layout is sequential for all its items.
-        // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-        // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
+        glBufferData(GL_ARRAY_BUFFER, geometry.vertexBytes(), geometry.vertices, GL_STATIC_DRAW);
+        if (skinned)
+            setupSkinnedAttributes();
+        else
+            setupStaticAttributes();
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-		
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, geometry.indexBytes(), geometry.indices, GL_STATIC_DRAW);
+
+        glBindVertexArray(0);
+    }
 
-        // set the vertex attribute pointers
+    // atributos 0..4 compartidos por ambos formatos
+    void setupBaseAttributes(GLsizei stride)
+    {
         // vertex Positions
-        glEnableVertexAttribArray(0);	
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(StaticVertex, Position));
         // vertex normals
-        glEnableVertexAttribArray(1);	
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(StaticVertex, Normal));
         // vertex texture coords
-        glEnableVertexAttribArray(2);	
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(StaticVertex, TexCoords));
         // vertex tangent
         glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
+        glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(StaticVertex, Tangent));
         // vertex bitangent
         glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
-		// vertex bones
-		glEnableVertexAttribArray(5);
-		glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, IDs1));
-		glEnableVertexAttribArray(6);
-		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, IDs2));
-		glEnableVertexAttribArray(7);
-		glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, IDs3));
-		
-		glEnableVertexAttribArray(8);
-		glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights1));
-		glEnableVertexAttribArray(9);
-		glVertexAttribPointer(9, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights2));
-		glEnableVertexAttribArray(10);
-		glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights3));
+        glVertexAttribPointer(4, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(StaticVertex, Bitangent));
+    }
 
-        glBindVertexArray(0);
+    void setupStaticAttributes()
+    {
+        setupBaseAttributes(sizeof(StaticVertex));
+        // sin huesos: los atributos 5..10 quedan apagados y leen el valor constante,
+        // que se deja en cero igual que los pesos vacios del formato anterior
+        for (unsigned int location = 5; location <= 10; location++)
+            glVertexAttrib4f(location, 0.0f, 0.0f, 0.0f, 0.0f);
     }
 
+    void setupSkinnedAttributes()
+    {
+        setupBaseAttributes(sizeof(SkinnedVertex));
+		// vertex bones: IDs como uint8 convertidos a float sin normalizar, pesos unorm8
+		for (unsigned int group = 0; group < 3; group++) {
+			glEnableVertexAttribArray(5 + group);
+			glVertexAttribPointer(5 + group, 4, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(SkinnedVertex),
+				(void*)(offsetof(SkinnedVertex, BoneIDs) + group * MAX_NUM_BONES));
+			glEnableVertexAttribArray(8 + group);
+			glVertexAttribPointer(8 + group, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SkinnedVertex),
+				(void*)(offsetof(SkinnedVertex, Weights) + group * MAX_NUM_BONES));
+		}
+    }
 	
 };
 #endif
\ No newline at end of file
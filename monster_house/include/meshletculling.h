@@ -0,0 +1,70 @@
+#ifndef MESHLETCULLING_H
+#define MESHLETCULLING_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+// Grupos pequenos de triangulos (meshlets) con su esfera envolvente y su cono de normales.
+// Los triangulos de cada meshlet quedan contiguos en el index buffer, asi que el renderer
+// descarta meshlets completos (fuera del frustum o de espaldas a la camara) y dibuja solo
+// los rangos que quedan.
+
+struct Meshlet {
+	glm::vec3 center;     // esfera envolvente, espacio del mesh
+	float     radius;
+	glm::vec3 coneAxis;   // normal media de los triangulos
+	float     coneCutoff; // seno de la apertura del cono; > 1 si el cono no sirve para descartar
+	uint32_t  firstIndex;
+	uint32_t  numIndices;
+	uint32_t  padding[2];
+};
+
+// Frustum y ojo en el espacio del modelo, para probar meshlets sin transformarlos
+struct MeshletCuller {
+	glm::vec4 planes[6];
+	glm::vec3 eye;
+	bool      coneCulling;
+
+	// mvp = projection * view * model. El cono solo se usa si el pipeline descarta caras
+	// traseras (backfaceCulling); si no, las caras de espaldas tambien se ven.
+	static MeshletCuller fromMatrices(const glm::mat4& mvp, const glm::mat4& model, const glm::vec3& eyeWorld, bool backfaceCulling)
+	{
+		MeshletCuller culler;
+		// Gribb-Hartmann: planos de la matriz combinada, ya en espacio del modelo
+		for (int i = 0; i < 3; i++) {
+			for (int side = 0; side < 2; side++) {
+				glm::vec4 plane;
+				for (int c = 0; c < 4; c++)
+					plane[c] = mvp[c][3] + (side ? -mvp[c][i] : mvp[c][i]);
+				float length = glm::length(glm::vec3(plane));
+				culler.planes[i * 2 + side] = length > 0.0f ? plane / length : plane;
+			}
+		}
+		culler.eye = glm::vec3(glm::inverse(model) * glm::vec4(eyeWorld, 1.0f));
+
+		// el cono solo vale con escala uniforme y sin espejo (si no, las normales cambian)
+		glm::vec3 scale(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])));
+		float low = std::min(std::min(scale.x, scale.y), scale.z), high = std::max(std::max(scale.x, scale.y), scale.z);
+		culler.coneCulling = backfaceCulling && high > 0.0f && (high - low) <= high * 0.01f && glm::determinant(glm::mat3(model)) > 0.0f;
+		return culler;
+	}
+
+	bool isVisible(const Meshlet& meshlet) const
+	{
+		for (int p = 0; p < 6; p++)
+			if (glm::dot(glm::vec3(planes[p]), meshlet.center) + planes[p].w < -meshlet.radius)
+				return false;
+
+		if (coneCulling && meshlet.coneCutoff <= 1.0f) {
+			// todos los triangulos de espaldas desde cualquier punto de la esfera
+			glm::vec3 view = meshlet.center - eye;
+			if (glm::dot(view, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(view) + meshlet.radius)
+				return false;
+		}
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef MESHLETS_H
+#define MESHLETS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <mesh.h>
+#include <meshletculling.h>
+#include <meshprocessing.h>
+
+// Construccion de meshlets en tiempo de importacion (el formato y la prueba de
+// visibilidad estan en meshletculling.h).
+
+// Triangulos por meshlet: se cierra al llegar al maximo; desde el minimo se cierra antes
+// si el siguiente triangulo abriria demasiado el cono de normales
+#define MESHLET_MAX_TRIANGLES 128
+#define MESHLET_MIN_TRIANGLES 64
+#define MESHLET_CONE_LIMIT 0.5f  // coseno minimo entre una normal nueva y el eje del meshlet
+
+inline void computeMeshletBounds(const Vertex* vertices, const unsigned int* indices, Meshlet& meshlet)
+{
+	glm::vec3 low(1e30f), high(-1e30f), axis(0.0f);
+	for (uint32_t i = 0; i < meshlet.numIndices; i++) {
+		low = glm::min(low, vertices[indices[i]].Position);
+		high = glm::max(high, vertices[indices[i]].Position);
+	}
+	meshlet.center = (low + high) * 0.5f;
+	meshlet.radius = 0.0f;
+	for (uint32_t i = 0; i < meshlet.numIndices; i++)
+		meshlet.radius = std::max(meshlet.radius, glm::length(vertices[indices[i]].Position - meshlet.center));
+
+	std::vector<glm::vec3> normals;
+	for (uint32_t t = 0; t + 2 < meshlet.numIndices; t += 3) {
+		const glm::vec3& p0 = vertices[indices[t]].Position;
+		glm::vec3 normal = glm::cross(vertices[indices[t + 1]].Position - p0, vertices[indices[t + 2]].Position - p0);
+		float length = glm::length(normal);
+		if (length <= 0.0f) continue;
+		normals.push_back(normal / length);
+		axis += normals.back();
+	}
+
+	float axisLength = glm::length(axis);
+	meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+	float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+	for (const glm::vec3& normal : normals)
+		minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+	// cono de mas de 90 grados: nunca esta completo de espaldas
+	meshlet.coneCutoff = minDot <= 0.0f ? 2.0f : std::sqrt(1.0f - minDot * minDot);
+}
+
+// Agrupa los triangulos de indices[first, first + count) en meshlets y los reordena para que
+// cada uno quede contiguo. Crecimiento voraz por adyacencia: se prefiere el triangulo vecino
+// que comparte mas vertices y cuya normal se parece al eje del meshlet.
+inline void buildMeshlets(const Vertex* vertices, size_t vertexCount, std::vector<unsigned int>& indices,
+	size_t first, size_t count, std::vector<Meshlet>& meshlets)
+{
+	size_t triangleCount = count / 3;
+	if (triangleCount == 0) return;
+	const unsigned int* source = indices.data() + first;
+	size_t firstMeshlet = meshlets.size();
+
+	// triangulos por vertice (CSR)
+	std::vector<unsigned int> offsets(vertexCount + 1, 0), adjacency(triangleCount * 3);
+	for (size_t i = 0; i < triangleCount * 3; i++) offsets[source[i] + 1]++;
+	for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacency[fill[source[i]]++] = (unsigned int)(i / 3);
+
+	std::vector<glm::vec3> normals(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++) {
+		const glm::vec3& p0 = vertices[source[t * 3]].Position;
+		glm::vec3 normal = glm::cross(vertices[source[t * 3 + 1]].Position - p0, vertices[source[t * 3 + 2]].Position - p0);
+		float length = glm::length(normal);
+		normals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+	}
+
+	std::vector<unsigned char> used(triangleCount, 0);
+	std::vector<unsigned int> inMeshlet(vertexCount, ~0u), candidates, result;
+	result.reserve(triangleCount * 3);
+	size_t seed = 0;
+
+	while (true) {
+		while (seed < triangleCount && used[seed]) seed++;
+		if (seed == triangleCount) break;
+
+		unsigned int id = (unsigned int)meshlets.size();
+		glm::vec3 axis(0.0f);
+		size_t start = result.size(), size = 0;
+		candidates.clear();
+
+		unsigned int next = (unsigned int)seed;
+		while (next != ~0u) {
+			used[next] = 1;
+			size++;
+			axis += normals[next];
+			for (int c = 0; c < 3; c++) {
+				unsigned int v = source[next * 3 + c];
+				result.push_back(v);
+				if (inMeshlet[v] == id) continue;
+				inMeshlet[v] = id;
+				for (unsigned int i = offsets[v]; i < offsets[v + 1]; i++)
+					if (!used[adjacency[i]]) candidates.push_back(adjacency[i]);
+			}
+			if (size >= MESHLET_MAX_TRIANGLES) break;
+
+			// mejor vecino: vertices compartidos + parecido de la normal con el eje
+			glm::vec3 direction = glm::length(axis) > 0.0f ? glm::normalize(axis) : axis;
+			next = ~0u;
+			float bestScore = -1e30f, bestCone = 1.0f;
+			size_t write = 0;
+			for (unsigned int t : candidates) {
+				if (used[t]) continue;
+				candidates[write++] = t;
+				int shared = 0;
+				for (int c = 0; c < 3; c++) shared += inMeshlet[source[t * 3 + c]] == id;
+				float cone = glm::dot(normals[t], direction);
+				float score = shared + cone;
+				if (score > bestScore) { bestScore = score; bestCone = cone; next = t; }
+			}
+			candidates.resize(write);
+			if (next != ~0u && size >= MESHLET_MIN_TRIANGLES && bestCone < MESHLET_CONE_LIMIT)
+				next = ~0u;
+		}
+
+		// orden para la cache de vertices dentro del meshlet, con indices locales para que
+		// el costo dependa del tamano del meshlet y no del mesh completo
+		std::vector<unsigned int> local, globalIds;
+		for (size_t i = start; i < result.size(); i++) {
+			unsigned int v = result[i];
+			if (inMeshlet[v] == id) {
+				inMeshlet[v] = (unsigned int)(~0u - 1 - globalIds.size());
+				globalIds.push_back(v);
+			}
+			local.push_back(~0u - 1 - inMeshlet[v]);
+		}
+		optimizeVertexCache(local, globalIds.size());
+		for (size_t i = 0; i < local.size(); i++)
+			result[start + i] = globalIds[local[i]];
+
+		Meshlet meshlet = {};
+		meshlet.firstIndex = (uint32_t)(first + start);
+		meshlet.numIndices = (uint32_t)(result.size() - start);
+		computeMeshletBounds(vertices, result.data() + start, meshlet);
+		meshlets.push_back(meshlet);
+	}
+
+	// la construccion voraz deja los meshlets en el orden de las semillas, que deshace el
+	// orden de optimizeOverdraw; se reordenan de afuera hacia adentro con el mismo criterio
+	size_t meshletCount = meshlets.size() - firstMeshlet;
+
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	std::vector<glm::vec3> centroids(meshletCount), clusterNormals(meshletCount);
+	for (size_t m = 0; m < meshletCount; m++) {
+		const Meshlet& meshlet = meshlets[firstMeshlet + m];
+		size_t begin = (meshlet.firstIndex - first) / 3;
+		glm::vec3 centroid;
+		float area = accumulateTriangles(vertices, result.data(), begin, begin + meshlet.numIndices / 3,
+			centroid, clusterNormals[m]);
+		centroids[m] = area > 0.0f ? centroid / area : meshlet.center;
+		meshCentroid += centroid;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+	std::vector<unsigned int> order = outsideInOrder(centroids, clusterNormals, meshCentroid);
+	std::vector<Meshlet> sorted;
+	sorted.reserve(meshletCount);
+	size_t write = first;
+	for (unsigned int m : order) {
+		Meshlet meshlet = meshlets[firstMeshlet + m];
+		std::copy(result.begin() + (meshlet.firstIndex - first),
+			result.begin() + (meshlet.firstIndex - first + meshlet.numIndices), indices.begin() + write);
+		meshlet.firstIndex = (uint32_t)write;
+		write += meshlet.numIndices;
+		sorted.push_back(meshlet);
+	}
+	std::copy(sorted.begin(), sorted.end(), meshlets.begin() + firstMeshlet);
+}
+
+#endif
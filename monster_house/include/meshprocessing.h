@@ -0,0 +1,323 @@
+#ifndef MESHPROCESSING_H
+#define MESHPROCESSING_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <mesh.h>
+#include <mappedfile.h>
+
+// Optimizacion de mallas en tiempo de importacion. Todo trabaja sobre listas de
+// triangulos indexadas; el resultado se guarda en el cache cocinado, asi que el
+// costo se paga una sola vez por archivo fuente.
+
+// Tamano de la cache post-transformacion que se simula para elegir el orden
+#define VERTEX_CACHE_SIZE 32
+// Tamano de la cache FIFO con la que se reporta el ACMR (hardware conservador)
+#define ACMR_CACHE_SIZE 16
+
+// Une vertices identicos bit a bit (Assimp entrega un vertice por esquina de cara).
+// Reescribe los indices.
+inline void weldVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	size_t count = vertices.size();
+	std::vector<unsigned int> remap(count);
+
+	// tabla hash abierta con capacidad potencia de dos
+	size_t capacity = 1;
+	while (capacity < count * 2) capacity <<= 1;
+	const unsigned int empty = ~0u;
+	std::vector<unsigned int> table(capacity, empty);
+
+	std::vector<Vertex> unique;
+	unique.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		const Vertex& v = vertices[i];
+		size_t slot = (size_t)hashBytes((const unsigned char*)&v, sizeof(Vertex)) & (capacity - 1);
+		for (;;) {
+			unsigned int entry = table[slot];
+			if (entry == empty) {
+				table[slot] = (unsigned int)unique.size();
+				remap[i] = (unsigned int)unique.size();
+				unique.push_back(v);
+				break;
+			}
+			if (std::memcmp(&unique[entry], &v, sizeof(Vertex)) == 0) {
+				remap[i] = entry;
+				break;
+			}
+			slot = (slot + 1) & (capacity - 1);
+		}
+	}
+
+	for (unsigned int& index : indices)
+		index = remap[index];
+	vertices.swap(unique);
+}
+
+// Puntaje de vertice de Forsyth ("Linear-Speed Vertex Cache Optimisation")
+inline float vertexCacheScore(int cachePosition, unsigned int liveTriangles)
+{
+	if (liveTriangles == 0) return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		// los vertices del ultimo triangulo tienen un puntaje fijo para no repetirlo
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.0f - (float)(cachePosition - 3) / (VERTEX_CACHE_SIZE - 3), 1.5f);
+	}
+	// favorece terminar vertices con pocos triangulos pendientes
+	return score + 2.0f * std::pow((float)liveTriangles, -0.5f);
+}
+
+// Reordena los triangulos para reutilizar la cache de vertices de la GPU
+inline void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	// adyacencia vertice -> triangulos; la parte viva de cada lista es [offset, offset + live)
+	std::vector<unsigned int> live(vertexCount, 0);
+	for (unsigned int index : indices) live[index]++;
+	std::vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] = offsets[v] + live[v];
+	std::vector<unsigned int> adjacency(indices.size());
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+		for (int k = 0; k < 3; k++)
+			adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		vertexScore[v] = vertexCacheScore(-1, live[v]);
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<char> emitted(triangleCount, 0);
+	int best = 0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		const unsigned int* tri = &indices[t * 3];
+		triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+		if (triangleScore[t] > triangleScore[best]) best = (int)t;
+	}
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	unsigned int cache[VERTEX_CACHE_SIZE + 3];
+	unsigned int cacheCount = 0;
+	size_t nextCandidate = 0;
+
+	while (best >= 0) {
+		emitted[best] = 1;
+		const unsigned int* tri = &indices[best * 3];
+
+		unsigned int newCache[VERTEX_CACHE_SIZE + 3];
+		unsigned int newCount = 0;
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = tri[k];
+			result.push_back(v);
+			newCache[newCount++] = v;
+
+			// quitar el triangulo de la parte viva de la adyacencia
+			unsigned int* list = &adjacency[offsets[v]];
+			for (unsigned int j = 0; j < live[v]; j++) {
+				if (list[j] == (unsigned int)best) {
+					std::swap(list[j], list[live[v] - 1]);
+					break;
+				}
+			}
+			live[v]--;
+		}
+		for (unsigned int i = 0; i < cacheCount; i++) {
+			unsigned int v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				newCache[newCount++] = v;
+		}
+
+		// los vertices que salen de la cache bajan su puntaje
+		for (unsigned int i = VERTEX_CACHE_SIZE; i < newCount; i++) {
+			unsigned int v = newCache[i];
+			cachePosition[v] = -1;
+			float score = vertexCacheScore(-1, live[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			for (unsigned int j = 0; j < live[v]; j++)
+				triangleScore[adjacency[offsets[v] + j]] += delta;
+		}
+		cacheCount = std::min(newCount, (unsigned int)VERTEX_CACHE_SIZE);
+		std::memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+
+		// actualizar puntajes de lo que sigue en cache y elegir el mejor triangulo vecino
+		best = -1;
+		float bestScore = -1.0f;
+		for (unsigned int i = 0; i < cacheCount; i++) {
+			unsigned int v = cache[i];
+			cachePosition[v] = (int)i;
+			float score = vertexCacheScore((int)i, live[v]);
+			float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			for (unsigned int j = 0; j < live[v]; j++) {
+				unsigned int t = adjacency[offsets[v] + j];
+				triangleScore[t] += delta;
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					best = (int)t;
+				}
+			}
+		}
+
+		// sin vecinos pendientes: continuar con el siguiente triangulo sin emitir
+		if (best < 0) {
+			while (nextCandidate < triangleCount && emitted[nextCandidate]) nextCandidate++;
+			if (nextCandidate < triangleCount) best = (int)nextCandidate;
+		}
+	}
+
+	indices.swap(result);
+}
+
+// Simula una cache FIFO y separa los triangulos en grupos donde la cache se reinicia
+// (los tres vertices fallan). Esos cortes se pueden reordenar sin perder ACMR.
+inline std::vector<unsigned int> findCacheClusters(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+	std::vector<unsigned int> clusters;
+	std::vector<unsigned int> timestamp(vertexCount, 0);
+	unsigned int time = ACMR_CACHE_SIZE + 1;
+
+	for (size_t t = 0; t < indices.size() / 3; t++) {
+		int misses = 0;
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = indices[t * 3 + k];
+			if (time - timestamp[v] > ACMR_CACHE_SIZE) {
+				timestamp[v] = time++;
+				misses++;
+			}
+		}
+		if (t == 0 || misses == 3)
+			clusters.push_back((unsigned int)t);
+	}
+	return clusters;
+}
+
+// Centroide ponderado por area y normal sumada de los triangulos [begin, end) de indices.
+// Devuelve el area (el doble, sin normalizar) para poder ponderar grupos entre si.
+inline float accumulateTriangles(const Vertex* vertices, const unsigned int* indices, size_t begin, size_t end,
+	glm::vec3& centroid, glm::vec3& normal)
+{
+	centroid = normal = glm::vec3(0.0f);
+	float area = 0.0f;
+	for (size_t t = begin; t < end; t++) {
+		const glm::vec3& p0 = vertices[indices[t * 3 + 0]].Position;
+		const glm::vec3& p1 = vertices[indices[t * 3 + 1]].Position;
+		const glm::vec3& p2 = vertices[indices[t * 3 + 2]].Position;
+		glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+		float triangleArea = glm::length(n);
+		centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+		normal += n;
+		area += triangleArea;
+	}
+	return area;
+}
+
+// Orden de afuera hacia adentro de grupos de triangulos (centroide y normal de cada uno):
+// primero los que estan mas lejos del centro del mesh en la direccion de su normal, que
+// son los que mas probablemente miran hacia la camara y tapan a los demas
+inline std::vector<unsigned int> outsideInOrder(const std::vector<glm::vec3>& centroids,
+	const std::vector<glm::vec3>& normals, const glm::vec3& meshCentroid)
+{
+	std::vector<float> sortKey(centroids.size());
+	for (size_t c = 0; c < centroids.size(); c++) {
+		float length = glm::length(normals[c]);
+		glm::vec3 n = length > 0.0f ? normals[c] / length : glm::vec3(0.0f);
+		sortKey[c] = glm::dot(centroids[c] - meshCentroid, n);
+	}
+
+	std::vector<unsigned int> order(centroids.size());
+	for (size_t c = 0; c < order.size(); c++) order[c] = (unsigned int)c;
+	std::stable_sort(order.begin(), order.end(),
+		[&sortKey](unsigned int a, unsigned int b) { return sortKey[a] > sortKey[b]; });
+	return order;
+}
+
+// Ordena los grupos de triangulos de afuera hacia adentro para que las caras que
+// miran hacia la camara se dibujen primero y tapen a las demas (menos overdraw).
+// Debe ejecutarse despues de optimizeVertexCache.
+inline void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	std::vector<unsigned int> clusters = findCacheClusters(indices, vertices.size());
+	if (clusters.size() < 2) return;
+
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+	std::vector<glm::vec3> clusterCentroid(clusters.size());
+	std::vector<glm::vec3> clusterNormal(clusters.size());
+
+	for (size_t c = 0; c < clusters.size(); c++) {
+		size_t begin = clusters[c];
+		size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+		glm::vec3 centroid;
+		float area = accumulateTriangles(vertices.data(), indices.data(), begin, end, centroid, clusterNormal[c]);
+		clusterCentroid[c] = area > 0.0f ? centroid / area : vertices[indices[begin * 3]].Position;
+		meshCentroid += centroid;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+	std::vector<unsigned int> order = outsideInOrder(clusterCentroid, clusterNormal, meshCentroid);
+
+	std::vector<unsigned int> result;
+	result.reserve(indices.size());
+	for (unsigned int c : order) {
+		size_t begin = clusters[c];
+		size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+		result.insert(result.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+	}
+	indices.swap(result);
+}
+
+// Reordena los vertices en el orden en que los usan los indices (mejor localidad
+// de lectura). Los vertices que ningun indice usa se descartan.
+inline void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+	std::vector<unsigned int> remap(vertices.size(), ~0u);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+	for (unsigned int& index : indices) {
+		if (remap[index] == ~0u) {
+			remap[index] = (unsigned int)ordered.size();
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(ordered);
+}
+
+// Average Cache Miss Ratio: vertices transformados por triangulo con una cache FIFO
+inline float computeACMR(const std::vector<unsigned int>& indices, size_t vertexCount)
+{
+	if (indices.size() < 3) return 0.0f;
+
+	std::vector<unsigned int> timestamp(vertexCount, 0);
+	unsigned int time = ACMR_CACHE_SIZE + 1;
+	size_t misses = 0;
+	for (unsigned int v : indices) {
+		if (time - timestamp[v] > ACMR_CACHE_SIZE) {
+			timestamp[v] = time++;
+			misses++;
+		}
+	}
+	return (float)misses / (float)(indices.size() / 3);
+}
+
+#endif
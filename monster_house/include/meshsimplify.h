@@ -0,0 +1,336 @@
+#ifndef MESHSIMPLIFY_H
+#define MESHSIMPLIFY_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include <mesh.h>
+#include <mappedfile.h>
+#include <meshprocessing.h>
+
+// Simplificacion por colapso de aristas con metrica de error cuadratica (Garland-Heckbert).
+// Un vertice solo se colapsa sobre otro que ya existe, asi que los LODs reutilizan el
+// vertex buffer del nivel 0 y solo agregan indices. Para no romper la apariencia:
+//  - las costuras (misma posicion con distinta normal/UV) solo se colapsan a lo largo de
+//    la costura: cada copia del vertice necesita una vecina en el destino;
+//  - los bordes abiertos solo se colapsan a lo largo del borde;
+//  - se rechazan los colapsos que voltean triangulos y se penaliza el cambio de normal.
+
+// Niveles por mesh, contando el original
+#define MAX_MESH_LODS 4
+// Cada LOD intenta quedarse con esta fraccion de los indices del anterior
+#define LOD_REDUCTION 0.5f
+// Si un LOD no baja de esta fraccion del anterior no vale la memoria y se corta la cadena
+#define LOD_MIN_REDUCTION 0.85f
+// Error maximo del primer LOD relativo al tamano del mesh; se multiplica por 4 en cada nivel
+#define LOD_BASE_ERROR 0.01f
+
+// Forma cuadratica simetrica de la suma de distancias al cuadrado a un conjunto de planos
+struct Quadric {
+	double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+	static Quadric fromPlane(const glm::vec3& n, float d, double weight)
+	{
+		Quadric q;
+		q.a2 = weight * n.x * n.x; q.ab = weight * n.x * n.y; q.ac = weight * n.x * n.z; q.ad = weight * n.x * d;
+		q.b2 = weight * n.y * n.y; q.bc = weight * n.y * n.z; q.bd = weight * n.y * d;
+		q.c2 = weight * n.z * n.z; q.cd = weight * n.z * d;
+		q.d2 = weight * d * d;
+		return q;
+	}
+
+	void add(const Quadric& q)
+	{
+		a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+		bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+	}
+
+	double evaluate(const glm::vec3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double result = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+			+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+			+ c2 * z * z + 2 * cd * z + d2;
+		return std::max(result, 0.0);
+	}
+};
+
+// Vertice representante de cada posicion (el primero con esos mismos bits)
+inline std::vector<unsigned int> buildPositionRemap(const Vertex* vertices, size_t vertexCount)
+{
+	std::vector<unsigned int> remap(vertexCount);
+	size_t capacity = 1;
+	while (capacity < vertexCount * 2) capacity <<= 1;
+	const unsigned int empty = ~0u;
+	std::vector<unsigned int> table(capacity, empty);
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		const glm::vec3& p = vertices[i].Position;
+		size_t slot = (size_t)hashBytes((const unsigned char*)&p, sizeof(glm::vec3)) & (capacity - 1);
+		for (;;) {
+			unsigned int entry = table[slot];
+			if (entry == empty) {
+				table[slot] = (unsigned int)i;
+				remap[i] = (unsigned int)i;
+				break;
+			}
+			if (std::memcmp(&vertices[entry].Position, &p, sizeof(glm::vec3)) == 0) {
+				remap[i] = entry;
+				break;
+			}
+			slot = (slot + 1) & (capacity - 1);
+		}
+	}
+	return remap;
+}
+
+inline uint64_t edgeKey(unsigned int a, unsigned int b)
+{
+	return ((uint64_t)a << 32) | b;
+}
+
+// Reduce una lista de triangulos hasta targetIndexCount indices o hasta que el siguiente
+// colapso supere targetError (relativo a la diagonal del mesh). resultError recibe el error
+// alcanzado en unidades del mesh.
+inline std::vector<unsigned int> simplifyMesh(const Vertex* vertices, size_t vertexCount,
+	const unsigned int* indexData, size_t indexCount, size_t targetIndexCount, float targetError, float* resultError = nullptr)
+{
+	std::vector<unsigned int> indices(indexData, indexData + indexCount);
+	if (resultError) *resultError = 0.0f;
+	if (vertexCount == 0 || indexCount < 3) return indices;
+
+	glm::vec3 low = vertices[0].Position, high = vertices[0].Position;
+	for (size_t i = 1; i < vertexCount; i++) {
+		low = glm::min(low, vertices[i].Position);
+		high = glm::max(high, vertices[i].Position);
+	}
+	float extent = glm::length(high - low);
+	if (extent <= 0.0f) return indices;
+	double maxCost = (double)targetError * extent * (double)targetError * extent;
+
+	// posiciones: representante y lista circular de las copias (costuras)
+	std::vector<unsigned int> position = buildPositionRemap(vertices, vertexCount);
+	std::vector<unsigned int> wedge(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) wedge[i] = (unsigned int)i;
+	for (size_t i = 0; i < vertexCount; i++) {
+		unsigned int rep = position[i];
+		if (rep != i) {
+			wedge[i] = wedge[rep];
+			wedge[rep] = (unsigned int)i;
+		}
+	}
+
+	// aristas dirigidas en espacio de posiciones: sin la inversa es borde, repetidas es no-manifold
+	std::unordered_set<uint64_t> directed, borderEdges;
+	std::vector<unsigned char> border(vertexCount, 0), locked(vertexCount, 0);
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		for (int e = 0; e < 3; e++) {
+			unsigned int a = position[indices[t + e]], b = position[indices[t + (e + 1) % 3]];
+			if (!directed.insert(edgeKey(a, b)).second)
+				locked[a] = locked[b] = 1;
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		unsigned int r[3] = { position[indices[t]], position[indices[t + 1]], position[indices[t + 2]] };
+		const glm::vec3& p0 = vertices[r[0]].Position;
+		const glm::vec3& p1 = vertices[r[1]].Position;
+		const glm::vec3& p2 = vertices[r[2]].Position;
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float length = glm::length(normal);
+		if (length <= 0.0f) continue;
+		normal /= length;
+
+		Quadric plane = Quadric::fromPlane(normal, -glm::dot(normal, p0), 1.0);
+		for (int c = 0; c < 3; c++) quadrics[r[c]].add(plane);
+
+		// los bordes abiertos suman un plano perpendicular a la cara que los mantiene en su lugar
+		for (int e = 0; e < 3; e++) {
+			unsigned int a = r[e], b = r[(e + 1) % 3];
+			if (directed.count(edgeKey(b, a))) continue;
+			borderEdges.insert(edgeKey(std::min(a, b), std::max(a, b)));
+			border[a] = border[b] = 1;
+			glm::vec3 edge = vertices[b].Position - vertices[a].Position;
+			glm::vec3 side = glm::cross(edge, normal);
+			float sideLength = glm::length(side);
+			if (sideLength <= 0.0f) continue;
+			side /= sideLength;
+			Quadric constraint = Quadric::fromPlane(side, -glm::dot(side, vertices[a].Position), 4.0);
+			quadrics[a].add(constraint);
+			quadrics[b].add(constraint);
+		}
+	}
+
+	struct Collapse {
+		unsigned int from, to;
+		double cost;
+	};
+
+	std::vector<unsigned int> triangleOffsets, triangleList, remap(vertexCount);
+	std::vector<unsigned char> touched(vertexCount);
+	std::vector<Collapse> collapses;
+	double reachedCost = 0.0;
+
+	// triangulos del vertice v, segun la lista armada al inicio de la pasada
+	auto forEachTriangle = [&](unsigned int v, auto&& visit) {
+		for (unsigned int i = triangleOffsets[v]; i < triangleOffsets[v + 1]; i++)
+			if (!visit(triangleList[i])) return false;
+		return true;
+	};
+
+	// vertice en la posicion "to" que comparte un triangulo con v (la misma isla de atributos)
+	auto findTarget = [&](unsigned int v, unsigned int to) {
+		unsigned int target = ~0u;
+		forEachTriangle(v, [&](size_t t) {
+			for (int c = 0; c < 3; c++) {
+				if (position[indices[t + c]] == to) {
+					target = indices[t + c];
+					return false;
+				}
+			}
+			return true;
+		});
+		return target;
+	};
+
+	while (indices.size() > targetIndexCount) {
+		// listas de triangulos por vertice (CSR)
+		triangleOffsets.assign(vertexCount + 1, 0);
+		for (unsigned int index : indices) triangleOffsets[index + 1]++;
+		for (size_t i = 0; i < vertexCount; i++) triangleOffsets[i + 1] += triangleOffsets[i];
+		triangleList.resize(indices.size());
+		std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+			triangleList[fill[indices[i]]++] = (unsigned int)(i - i % 3);
+
+		// candidatos: las dos direcciones de cada arista, con su costo
+		collapses.clear();
+		for (size_t t = 0; t < indices.size(); t += 3) {
+			for (int e = 0; e < 3; e++) {
+				unsigned int a = position[indices[t + e]], b = position[indices[t + (e + 1) % 3]];
+				if (a == b) continue;
+				for (int direction = 0; direction < 2; direction++) {
+					unsigned int from = direction ? b : a, to = direction ? a : b;
+					if (locked[from]) continue;
+					if (border[from] && !borderEdges.count(edgeKey(std::min(a, b), std::max(a, b)))) continue;
+					Collapse collapse = { from, to, quadrics[from].evaluate(vertices[to].Position) + quadrics[to].evaluate(vertices[to].Position) };
+					collapses.push_back(collapse);
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		for (size_t i = 0; i < vertexCount; i++) remap[i] = (unsigned int)i;
+		std::fill(touched.begin(), touched.end(), 0);
+
+		// cada colapso quita unos dos triangulos; se para al llegar al objetivo estimado
+		size_t removable = (indices.size() - targetIndexCount) / 3, removed = 0, applied = 0;
+		for (const Collapse& collapse : collapses) {
+			if (collapse.cost > maxCost || removed >= removable) break;
+			if (touched[collapse.from] || touched[collapse.to]) continue;
+
+			const glm::vec3& target = vertices[collapse.to].Position;
+			bool valid = true;
+			double normalPenalty = 0.0;
+			size_t shared = 0;
+
+			// cada copia de "from" necesita su pareja en "to"; y ningun triangulo puede voltearse
+			unsigned int w = collapse.from;
+			do {
+				if (triangleOffsets[w] != triangleOffsets[w + 1]) {
+					unsigned int pair = findTarget(w, collapse.to);
+					if (pair == ~0u) { valid = false; break; }
+					float edge2 = glm::dot(target - vertices[w].Position, target - vertices[w].Position);
+					normalPenalty += (1.0 - glm::dot(vertices[w].Normal, vertices[pair].Normal)) * edge2;
+
+					valid = forEachTriangle(w, [&](size_t t) {
+						unsigned int r[3] = { position[indices[t]], position[indices[t + 1]], position[indices[t + 2]] };
+						if (r[0] == collapse.to || r[1] == collapse.to || r[2] == collapse.to) {
+							shared++;
+							return true;
+						}
+						glm::vec3 p[3], q[3];
+						for (int c = 0; c < 3; c++) {
+							p[c] = vertices[r[c]].Position;
+							q[c] = r[c] == collapse.from ? target : p[c];
+						}
+						glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+						glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+						return glm::dot(before, after) > 0.0f;
+					});
+					if (!valid) break;
+				}
+				w = wedge[w];
+			} while (w != collapse.from);
+			if (!valid || collapse.cost + normalPenalty > maxCost) continue;
+
+			// aplicar: se bloquea el anillo de "from" para que los chequeos de esta pasada sigan valiendo
+			w = collapse.from;
+			do {
+				if (triangleOffsets[w] != triangleOffsets[w + 1]) {
+					remap[w] = findTarget(w, collapse.to);
+					forEachTriangle(w, [&](size_t t) {
+						for (int c = 0; c < 3; c++) touched[position[indices[t + c]]] = 1;
+						return true;
+					});
+				}
+				w = wedge[w];
+			} while (w != collapse.from);
+			touched[collapse.from] = touched[collapse.to] = 1;
+			quadrics[collapse.to].add(quadrics[collapse.from]);
+			reachedCost = std::max(reachedCost, collapse.cost + normalPenalty);
+			removed += shared;
+			applied++;
+		}
+		if (applied == 0) break;
+
+		// reescribir indices y quitar los triangulos degenerados
+		size_t write = 0;
+		for (size_t t = 0; t < indices.size(); t += 3) {
+			unsigned int a = remap[indices[t]], b = remap[indices[t + 1]], c = remap[indices[t + 2]];
+			if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c]) continue;
+			indices[write++] = a;
+			indices[write++] = b;
+			indices[write++] = c;
+		}
+		indices.resize(write);
+	}
+
+	if (resultError) *resultError = (float)std::sqrt(reachedCost);
+	return indices;
+}
+
+// Cadena de LODs de una lista de triangulos. indices queda con el nivel 0 seguido de los
+// indices de cada nivel simplificado; lods recibe los rangos (vacio si no hubo reduccion).
+inline void buildMeshLods(const Vertex* vertices, size_t vertexCount, std::vector<unsigned int>& indices, std::vector<MeshLod>& lods)
+{
+	lods.clear();
+	MeshLod base = { 0, (uint32_t)indices.size(), 0.0f, 0 };
+	lods.push_back(base);
+
+	float targetError = LOD_BASE_ERROR;
+	for (int level = 1; level < MAX_MESH_LODS; level++, targetError *= 4.0f) {
+		const MeshLod& previous = lods.back();
+		size_t target = (size_t)(previous.numIndices * LOD_REDUCTION) / 3 * 3;
+		float error = 0.0f;
+		std::vector<unsigned int> simplified = simplifyMesh(vertices, vertexCount,
+			indices.data() + previous.firstIndex, previous.numIndices, target, targetError, &error);
+		if (simplified.empty() || simplified.size() > previous.numIndices * LOD_MIN_REDUCTION)
+			break;
+		optimizeVertexCache(simplified, vertexCount);
+
+		MeshLod lod = { (uint32_t)indices.size(), (uint32_t)simplified.size(), previous.error + error, 0 };
+		indices.insert(indices.end(), simplified.begin(), simplified.end());
+		lods.push_back(lod);
+	}
+
+	if (lods.size() == 1) lods.clear();
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef MIPGEN_H
+#define MIPGEN_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIPGEN_AVX2 1
+#endif
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIPGEN_SSE2 1
+#endif
+
+// ============================================================================
+// GENERACION DE MIPS EN CPU
+// Las imagenes de color estan en sRGB: promediarlas en bytes oscurece los mips
+// (y los bordes de alto contraste). Aqui cada nivel se trabaja en float lineal:
+// sRGB -> lineal con tabla, promedio 2x2 con SIMD y de vuelta a sRGB. Los mapas de
+// normales se decodifican a [-1, 1], se promedian y se renormalizan. Los mapas de datos
+// (especular, altura, un canal) ya son lineales y se promedian tal cual.
+// El alfa siempre se filtra lineal.
+// ============================================================================
+
+enum MipFilter {
+	MIP_FILTER_SRGB,   // color: promedio en espacio lineal
+	MIP_FILTER_NORMAL, // mapa de normales: promedio y renormalizacion
+	MIP_FILTER_LINEAR  // datos: promedio directo de los valores
+};
+
+// Tablas de conversion compartidas (se construyen una vez, seguras entre hilos en C++11)
+struct SRGBTables {
+	float         toLinear[256];
+	unsigned char fromLinear[4096]; // indice = lineal * 4095
+
+	SRGBTables()
+	{
+		for (int i = 0; i < 256; i++) {
+			float c = i / 255.0f;
+			toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < 4096; i++) {
+			float l = i / 4095.0f;
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+			fromLinear[i] = (unsigned char)(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+	}
+
+	static const SRGBTables& get()
+	{
+		static SRGBTables tables;
+		return tables;
+	}
+};
+
+// Imagen de trabajo RGBA en float
+struct MipImage {
+	int                width = 0;
+	int                height = 0;
+	std::vector<float> pixels;
+};
+
+inline void decodeMipImage(const unsigned char* rgba, int width, int height, MipFilter filter, MipImage& image)
+{
+	const SRGBTables& tables = SRGBTables::get();
+	image.width = width;
+	image.height = height;
+	image.pixels.resize((size_t)width * height * 4);
+
+	size_t count = (size_t)width * height;
+	float* out = image.pixels.data();
+	for (size_t i = 0; i < count; i++, rgba += 4, out += 4) {
+		if (filter == MIP_FILTER_SRGB) {
+			out[0] = tables.toLinear[rgba[0]];
+			out[1] = tables.toLinear[rgba[1]];
+			out[2] = tables.toLinear[rgba[2]];
+		}
+		else if (filter == MIP_FILTER_LINEAR) {
+			out[0] = rgba[0] * (1.0f / 255.0f);
+			out[1] = rgba[1] * (1.0f / 255.0f);
+			out[2] = rgba[2] * (1.0f / 255.0f);
+		}
+		else {
+			out[0] = rgba[0] * (2.0f / 255.0f) - 1.0f;
+			out[1] = rgba[1] * (2.0f / 255.0f) - 1.0f;
+			out[2] = rgba[2] * (2.0f / 255.0f) - 1.0f;
+		}
+		out[3] = rgba[3] * (1.0f / 255.0f);
+	}
+}
+
+inline void encodeMipImage(const MipImage& image, MipFilter filter, std::vector<unsigned char>& rgba)
+{
+	const SRGBTables& tables = SRGBTables::get();
+	size_t count = (size_t)image.width * image.height;
+	rgba.resize(count * 4);
+
+	const float* in = image.pixels.data();
+	unsigned char* out = rgba.data();
+	for (size_t i = 0; i < count; i++, in += 4, out += 4) {
+		if (filter == MIP_FILTER_SRGB) {
+			for (int c = 0; c < 3; c++) {
+				float l = std::min(std::max(in[c], 0.0f), 1.0f);
+				out[c] = tables.fromLinear[(int)(l * 4095.0f + 0.5f)];
+			}
+		}
+		else if (filter == MIP_FILTER_LINEAR) {
+			for (int c = 0; c < 3; c++)
+				out[c] = (unsigned char)(std::min(std::max(in[c], 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+		else {
+			for (int c = 0; c < 3; c++)
+				out[c] = (unsigned char)(std::min(std::max(in[c] * 0.5f + 0.5f, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+		out[3] = (unsigned char)(std::min(std::max(in[3], 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+// Promedio 2x2 de una fila de salida. La version SIMD cubre los pixeles cuyo par de
+// origen esta completo; el borde impar (columna repetida) va por el camino escalar.
+inline void downsampleRow(const float* row0, const float* row1, int sourceWidth, float* out, int outWidth)
+{
+	int x = 0;
+#if defined(MIPGEN_AVX2)
+	// un __m256 = dos pixeles RGBA contiguos de la fila de origen
+	const __m128 quarter = _mm_set1_ps(0.25f);
+	for (; x < outWidth && x * 2 + 1 < sourceWidth; x++) {
+		__m256 sum = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8));
+		__m128 pixel = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+		_mm_storeu_ps(out + x * 4, _mm_mul_ps(pixel, quarter));
+	}
+#elif defined(MIPGEN_SSE2)
+	const __m128 quarter = _mm_set1_ps(0.25f);
+	for (; x < outWidth && x * 2 + 1 < sourceWidth; x++) {
+		__m128 top = _mm_add_ps(_mm_loadu_ps(row0 + x * 8), _mm_loadu_ps(row0 + x * 8 + 4));
+		__m128 bottom = _mm_add_ps(_mm_loadu_ps(row1 + x * 8), _mm_loadu_ps(row1 + x * 8 + 4));
+		_mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+	}
+#endif
+	for (; x < outWidth; x++) {
+		int x0 = std::min(x * 2, sourceWidth - 1), x1 = std::min(x * 2 + 1, sourceWidth - 1);
+		for (int c = 0; c < 4; c++)
+			out[x * 4 + c] = (row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c]) * 0.25f;
+	}
+}
+
+inline void renormalizeRow(float* pixels, int count)
+{
+	int x = 0;
+#if defined(MIPGEN_SSE2)
+	for (; x < count; x++) {
+		__m128 n = _mm_loadu_ps(pixels + x * 4);
+		// solo xyz; el alfa se conserva
+		__m128 xyz = _mm_and_ps(n, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+		__m128 squared = _mm_mul_ps(xyz, xyz);
+		__m128 sum = _mm_add_ps(squared, _mm_shuffle_ps(squared, squared, _MM_SHUFFLE(2, 3, 0, 1)));
+		sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		if (_mm_cvtss_f32(sum) <= 1e-12f) continue;
+		__m128 normalized = _mm_div_ps(xyz, _mm_sqrt_ps(sum));
+		float alpha = pixels[x * 4 + 3];
+		_mm_storeu_ps(pixels + x * 4, normalized);
+		pixels[x * 4 + 3] = alpha;
+	}
+#endif
+	for (; x < count; x++) {
+		float* n = pixels + x * 4;
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length <= 1e-6f) continue;
+		n[0] /= length; n[1] /= length; n[2] /= length;
+	}
+}
+
+// Siguiente nivel de mip (mitad de tamano; los bordes impares se repiten)
+inline void downsampleMip(const MipImage& source, MipFilter filter, MipImage& out)
+{
+	out.width = std::max(1, source.width / 2);
+	out.height = std::max(1, source.height / 2);
+	out.pixels.resize((size_t)out.width * out.height * 4);
+
+	for (int y = 0; y < out.height; y++) {
+		int y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+		float* row = out.pixels.data() + (size_t)y * out.width * 4;
+		downsampleRow(source.pixels.data() + (size_t)y0 * source.width * 4,
+			source.pixels.data() + (size_t)y1 * source.width * 4, source.width, row, out.width);
+		if (filter == MIP_FILTER_NORMAL)
+			renormalizeRow(row, out.width);
+	}
+}
+
+#endif
@@ -3,13 +3,17 @@
 
 #include <glm/gtx/string_cast.hpp>
 
+#include <cfloat>
+
 #include <modelstructs.h>
+#include <modelcache.h>
+#include <skeleton.h>
+#include <textureregistry.h>
 
 class Model
 {
 public:
 	/*  Model Data */
-	vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
 	vector<Mesh> meshes;
 	string directory;
 	bool gammaCorrection;
@@ -19,34 +23,40 @@ public:
 	/* Bones data */
 	vector<Bone> bones;
 
-	/* Scene data */
-	Assimp::Importer importer;
-	const aiScene* scene;
-
 	map<string, unsigned int> m_BoneMapping; // maps a bone name to its index
 	unsigned int m_NumBones;
 	vector<BoneInfo> m_BoneInfo;
 	glm::mat4 m_GlobalInverseTransform;
 
 	/* Material data - NUEVO */
-	struct MaterialProperties {
-		glm::vec4 ambient;
-		glm::vec4 diffuse;
-		glm::vec4 specular;
-		float metallic;
-		float roughness;
-		float ior;
-		float alpha;
-	};
 	vector<MaterialProperties> materials; // Materiales cargados desde el FBX
 
+	/* Animation data */
+	vector<NodeData> nodes;             // jerarquia de nodos en preorden
+	vector<AnimationClip> animations;    // clips independientes de la escena de Assimp
+	CompiledSkeleton skeleton;           // nodos, canales y huesos resueltos al cargar
+	AnimationCursor poseCursor;          // ultima clave usada por canal en esta reproduccion
+
+	/* Bounds: caja y esfera envolventes de todos los meshes, en espacio del modelo */
+	Bounds bounds = Bounds::empty();
+
+	/* Streaming: distancia mas corta a la camara con la que se dibujo desde la ultima
+	   vez que el AssetStreamer la leyo (FLT_MAX si no se dibujo); ordena los refinamientos */
+	float viewDistance = FLT_MAX;
+
+	/* Collision data (solo con ImportOptions::keepCollisionGeometry) */
+	vector<CollisionMesh> collision;     // una entrada por mesh, en el espacio del mesh
+
 	/*  Functions   */
 	// constructor, expects a filepath to a 3D model.
-	Model(string const& path, bool gamma = false) : gammaCorrection(gamma)
+	Model(string const& path, bool gamma = false, const ImportOptions& options = ImportOptions()) : gammaCorrection(gamma)
 	{
-		loadModel(path);
+		loadModel(path, options);
 	}
 
+	// constructor vacio para la carga en segundo plano: el AssetLoader lo llena por etapas
+	Model() : gammaCorrection(false), m_NumBones(0), m_GlobalInverseTransform(1.0f) {}
+
 	// draws the model, and thus all its meshes
 	void Draw(Shader shader)
 	{
@@ -54,582 +64,216 @@ public:
 			meshes[i].Draw(shader);
 	}
 
-	// update transformations in time 
-	void SetPose(float time, glm::mat4* gBones) {
+	// dibuja un nivel de detalle (0 = completo); cada mesh usa el suyo o su ultimo nivel.
+	// culler (opcional) descarta los meshlets fuera de camara o de espaldas en el nivel 0.
+	void Draw(Shader shader, unsigned int lod, const MeshletCuller* culler = nullptr)
+	{
+		for (unsigned int i = 0; i < meshes.size(); i++)
+			meshes[i].Draw(shader, lod, culler);
+	}
 
-		// processNode(scene->mRootNode, time);
-		glm::mat4 n_matrix(1.0f);
-		ReadNodeHierarchy(time, scene->mRootNode, n_matrix);
+	unsigned int getLodCount() const
+	{
+		unsigned int count = 1;
+		for (const Mesh& mesh : meshes)
+			count = std::max(count, mesh.getLodCount());
+		return count;
+	}
 
-		for (unsigned int i = 0; i < bones.size(); i++) {
-			if (i < 100) {
+	// peor desviacion geometrica del nivel entre todos los meshes (unidades del modelo)
+	float getLodError(unsigned int lod) const
+	{
+		float error = 0.0f;
+		for (const Mesh& mesh : meshes)
+			error = std::max(error, mesh.getLodError(lod));
+		return error;
+	}
 
-				gBones[i] = bones[i].transformation;
-				// cout << "bone: " << i << " : " << bones[i].name.data << " T= " << glm::to_string(gBones[i]) << endl;
-			}
+	glm::vec3 getBoundingCenter() const { return bounds.center; }
+	float getBoundingRadius() const { return std::max(bounds.radius, 0.0f); }
+
+	// update transformations in time: una pasada lineal sobre el skeleton compilado
+	void SetPose(float time, glm::mat4* gBones) {
+		if (animations.empty()) {
+			for (unsigned int i = 0; i < bones.size() && i < 100; i++)
+				gBones[i] = glm::mat4(1.0f);
+			return;
 		}
+		skeleton.evaluate(0, time, m_GlobalInverseTransform, poseCursor, gBones, 100);
 	}
 
 	// Return the duration of the animation in ticks (frames)
 	double getNumFrames() {
 
-		const aiAnimation* pAnimation = scene->mAnimations[0];
-		if (pAnimation == nullptr) return -1.0;
+		if (animations.empty()) return -1.0;
+		const AnimationClip& animation = animations[0];
 
-		cout << "Animation total frames:" << pAnimation->mDuration << endl;
+		cout << "Animation total frames:" << animation.duration << endl;
 
-		return pAnimation->mDuration;
+		return animation.duration;
 
 	}
 
 	// return the number of ticks per second
 	double getFramerate() {
-		const aiAnimation* pAnimation = scene->mAnimations[0];
-		if (pAnimation == nullptr) return -1.0;
-
-		cout << "Animation framerate:" << pAnimation->mTicksPerSecond << " fps" << endl;
+		if (animations.empty()) return -1.0;
+		const AnimationClip& animation = animations[0];
 
-		return  pAnimation->mTicksPerSecond;
-	}
+		cout << "Animation framerate:" << animation.ticksPerSecond << " fps" << endl;
 
-	// NUEVO: Obtener material por índice
-	MaterialProperties getMaterial(unsigned int meshIndex) const {
-		if (meshIndex < materials.size()) {
-			return materials[meshIndex];
-		}
-		// Retornar material por defecto si no existe
-		MaterialProperties defaultMat;
-		defaultMat.ambient = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
-		defaultMat.diffuse = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
-		defaultMat.specular = glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);
-		defaultMat.metallic = 0.0f;
-		defaultMat.roughness = 0.5f;
-		defaultMat.ior = 1.45f;
-		defaultMat.alpha = 1.0f;
-		return defaultMat;
+		return  animation.ticksPerSecond;
 	}
 
-private:
-
-	/*  Functions   */
-
-	inline glm::mat4 aiMatrix4x4ToGlm(aiMatrix4x4 from)
+	// Carga por etapas. 1) datos de CPU del modelo (sin OpenGL)
+	void setupModelInfo(const ModelData& data)
 	{
-		glm::mat4 to;
-
-		to[0][0] = (GLfloat)from.a1; to[0][1] = (GLfloat)from.b1;  to[0][2] = (GLfloat)from.c1; to[0][3] = (GLfloat)from.d1;
-		to[1][0] = (GLfloat)from.a2; to[1][1] = (GLfloat)from.b2;  to[1][2] = (GLfloat)from.c2; to[1][3] = (GLfloat)from.d2;
-		to[2][0] = (GLfloat)from.a3; to[2][1] = (GLfloat)from.b3;  to[2][2] = (GLfloat)from.c3; to[2][3] = (GLfloat)from.d3;
-		to[3][0] = (GLfloat)from.a4; to[3][1] = (GLfloat)from.b4;  to[3][2] = (GLfloat)from.c4; to[3][3] = (GLfloat)from.d4;
-
-		return to;
+		filename = data.path;
+		directory = data.directory;
+		m_GlobalInverseTransform = data.globalInverseTransform;
+		m_NumBones = data.numBones;
+		bones = data.bones;
+		materials = data.materials;
+		nodes = data.nodes;
+		skeleton.compile(nodes, bones, data.animations);
+		animations = clipHeaders(data.animations);
+		keepCollisionGeometry = data.options.keepCollisionGeometry;
 	}
 
-	// loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
-	void loadModel(string const& path)
+	// 2) entrega una textura ya subida al TextureRegistry para que los meshes la usen
+	// sin volver a leer el archivo (hilo GL). roleKey viene de textureRoleKey().
+	void addTexture(const string& roleKey, const TextureHandle& handle)
 	{
-		// read file via ASSIMP
-		scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-		// check for errors
-		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
-		{
-			cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-			return;
-		}
-		filename = path;
-		// retrieve the directory path of the filepath
-		directory = path.substr(0, path.find_last_of('/'));
-
-		aiMatrix4x4 inverseTransform = scene->mRootNode->mTransformation;
-		inverseTransform.Inverse();
-		m_GlobalInverseTransform = aiMatrix4x4ToGlm(inverseTransform);
-
-		// process ASSIMP's root node recursively
-		processNode(scene->mRootNode, scene);
-
-		// NUEVO: Cargar materiales
-		loadMaterials(scene);
+		pendingTextures[roleKey] = handle;
 	}
 
-	// NUEVO: Cargar propiedades de materiales desde Assimp
-	void loadMaterials(const aiScene* scene) {
-		materials.clear();
-
-		for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
-			aiMaterial* mat = scene->mMaterials[i];
-			MaterialProperties matProps;
-
-			// Cargar colores
-			aiColor3D color;
-			if (mat->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS) {
-				matProps.ambient = glm::vec4(color.r, color.g, color.b, 1.0f);
-			}
-			else {
-				matProps.ambient = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
-			}
-
-			if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
-				matProps.diffuse = glm::vec4(color.r, color.g, color.b, 1.0f);
-			}
-			else {
-				matProps.diffuse = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
-			}
-
-			if (mat->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) {
-				matProps.specular = glm::vec4(color.r, color.g, color.b, 1.0f);
-			}
-			else {
-				matProps.specular = glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);
-			}
-
-			// Cargar propiedades PBR
-			float value;
-			if (mat->Get(AI_MATKEY_METALLIC_FACTOR, value) == AI_SUCCESS) {
-				matProps.metallic = value;
-			}
-			else {
-				matProps.metallic = 0.0f;
-			}
-
-			if (mat->Get(AI_MATKEY_ROUGHNESS_FACTOR, value) == AI_SUCCESS) {
-				matProps.roughness = value;
-			}
-			else {
-				matProps.roughness = 0.5f;
-			}
-
-			if (mat->Get(AI_MATKEY_REFRACTI, value) == AI_SUCCESS) {
-				matProps.ior = value;
-			}
-			else {
-				matProps.ior = 1.45f;
-			}
-
-			// Cargar transparencia (Alpha)
-			if (mat->Get(AI_MATKEY_OPACITY, value) == AI_SUCCESS) {
-				matProps.alpha = value;
-			}
-			else {
-				matProps.alpha = 1.0f;
-			}
-
-			materials.push_back(matProps);
-		}
-	}
-
-	void processNode(aiNode* node, float time) {
-
-		if (node == nullptr) return;
-
-		glm::mat4 n_matrix(1.0f);
-		ReadNodeHierarchy(time, node, n_matrix);
-
-	}
-
-	// processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-	void processNode(aiNode* node, const aiScene* scene)
+	// 3) crea los buffers de un mesh y resuelve sus texturas (hilo GL). Con proxy solo se
+	// sube su LOD mas simple; el mesh completo llega despues con refineMesh()
+	void addMesh(const MeshData& mesh, const MeshProxy* proxy = nullptr)
 	{
-		// cout << node->mName.data << endl;
-		// cout << "Meshes: " << node->mNumMeshes << endl;
-		// process each mesh located at the current node
-		for (unsigned int i = 0; i < node->mNumMeshes; i++)
-		{
-			// the node object only contains indices to index the actual objects in the scene. 
-			// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			// cout << "Mesh: " << mesh->mName.data << endl;
-			meshes.push_back(processMesh(mesh, scene));
+		if (proxy) {
+			meshes.push_back(Mesh(proxy->geometry(), loadMaterialTextures(mesh.textures)));
+			meshes.back().residentLod = proxy->lod;
 		}
-		// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-		for (unsigned int i = 0; i < node->mNumChildren; i++)
-		{
-			processNode(node->mChildren[i], scene);
+		else {
+			meshes.push_back(Mesh(mesh.geometry(), loadMaterialTextures(mesh.textures), mesh.submeshes, mesh.lods, mesh.meshlets));
 		}
-
-	}
-
-	Mesh processMesh(aiMesh* mesh, const aiScene* scene)
-	{
-		// data to fill
-		vector<Vertex> vertices;
-		vector<unsigned int> indices;
-		vector<Texture> textures;
-
-		// Walk through each of the mesh's vertices
-		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-		{
-			Vertex vertex;
-			glm::vec3 vector;
-
-			// positions
-			vector.x = mesh->mVertices[i].x;
-			vector.y = mesh->mVertices[i].y;
-			vector.z = mesh->mVertices[i].z;
-			vertex.Position = vector;
-
-			// normals
-			vector.x = mesh->mNormals[i].x;
-			vector.y = mesh->mNormals[i].y;
-			vector.z = mesh->mNormals[i].z;
-			vertex.Normal = vector;
-
-			// texture coordinates
-			if (mesh->mTextureCoords[0])
-			{
-				glm::vec2 vec;
-				vec.x = mesh->mTextureCoords[0][i].x;
-				vec.y = mesh->mTextureCoords[0][i].y;
-				vertex.TexCoords = vec;
-			}
-			else
-				vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-
-			// tangent
-			vector.x = mesh->mTangents[i].x;
-			vector.y = mesh->mTangents[i].y;
-			vector.z = mesh->mTangents[i].z;
-			vertex.Tangent = vector;
-
-			// bitangent
-			vector.x = mesh->mBitangents[i].x;
-			vector.y = mesh->mBitangents[i].y;
-			vector.z = mesh->mBitangents[i].z;
-			vertex.Bitangent = vector;
-
-			// Bones
-			int bcount = 0;
-			for (unsigned int pb = 0; pb < MAX_NUM_BONES; pb++) {
-				vertex.IDs1[pb] = 0.0f;
-				vertex.IDs2[pb] = 0.0f;
-				vertex.IDs3[pb] = 0.0f;
-				vertex.Weights1[pb] = 0.0f;
-				vertex.Weights2[pb] = 0.0f;
-				vertex.Weights3[pb] = 0.0f;
-			}
-			m_NumBones = mesh->mNumBones;
-			for (unsigned int j = 0; j < mesh->mNumBones; j++) {
-
-				for (unsigned int k = 0; k < mesh->mBones[j]->mNumWeights; k++) {
-					unsigned int VertexID = mesh->mBones[j]->mWeights[k].mVertexId;
-					float Weight = (float)(mesh->mBones[j]->mWeights[k].mWeight);
-					if (VertexID == i && bcount < MAX_NUM_BONES) {
-						vertex.IDs1[bcount] = (float)j;
-						vertex.Weights1[bcount] = Weight;
-						bcount++;
-					}
-					if (VertexID == i && bcount >= MAX_NUM_BONES && bcount < 2 * MAX_NUM_BONES) {
-						vertex.IDs2[bcount - MAX_NUM_BONES] = (float)j;
-						vertex.Weights2[bcount - MAX_NUM_BONES] = Weight;
-						bcount++;
-					}
-					if (VertexID == i && bcount >= 2 * MAX_NUM_BONES && bcount < 3 * MAX_NUM_BONES) {
-						vertex.IDs3[bcount - 2 * MAX_NUM_BONES] = (float)j;
-						vertex.Weights3[bcount - 2 * MAX_NUM_BONES] = Weight;
-						bcount++;
-					}
-				}
-			}
-			vertices.push_back(vertex);
-		}
-
-		// Process Bones
-		bones.clear();
-		for (unsigned int i = 0; i < mesh->mNumBones; i++) {
-			Bone  newBone;
-			newBone.name = mesh->mBones[i]->mName;
-			newBone.offsetMatrix = aiMatrix4x4ToGlm(mesh->mBones[i]->mOffsetMatrix);
-			newBone.transformation = glm::mat4(1.0f);
-
-			for (unsigned int j = 0; j < mesh->mBones[i]->mNumWeights; j++) {
-				unsigned int VertexID = mesh->mBones[i]->mWeights[j].mVertexId;
-				float Weight = mesh->mBones[i]->mWeights[j].mWeight;
-				newBone.push(VertexID, Weight);
-			}
-
-			bones.push_back(newBone);
+		meshes.back().bounds = mesh.bounds;
+		for (const TextureRef& ref : mesh.textures) {
+			if (!ref.solidColor) continue;
+			meshes.back().hasSolidColor = true;
+			meshes.back().solidColor = ref.color;
 		}
-
-		// Process faces
-		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-		{
-			aiFace face = mesh->mFaces[i];
-			for (unsigned int j = 0; j < face.mNumIndices; j++)
-				indices.push_back(face.mIndices[j]);
+		bounds.merge(mesh.bounds);
+
+		if (keepCollisionGeometry) {
+			MeshGeometry geometry = mesh.geometry();
+			CollisionMesh shape;
+			shape.positions.reserve(mesh.numVertices);
+			for (size_t i = 0; i < mesh.numVertices; i++)
+				shape.positions.push_back(geometry.position(i));
+			shape.indices.resize(mesh.baseIndexCount());
+			for (size_t i = 0; i < shape.indices.size(); i++)
+				shape.indices[i] = geometry.index(i);
+			collision.push_back(std::move(shape));
 		}
-
-		// process materials
-		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-		// 1. diffuse maps
-		vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-		textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-
-		// 2. specular maps
-		vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-		textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-
-		// 3. normal maps
-		std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-
-		// 4. height maps
-		std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-		textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-		return Mesh(vertices, indices, textures);
 	}
 
-	void ReadNodeHierarchy(float AnimationTime, const aiNode* pNode, const glm::mat4& ParentTransform)
+	// 4) el modelo ya esta completo en la GPU; los meshes ya tienen sus handles
+	void finishLoading()
 	{
-		if (pNode == nullptr || scene == nullptr) return;
-
-		string NodeName(pNode->mName.data);
-
-		const aiAnimation* pAnimation = scene->mAnimations[0];
-
-		//cout << NodeName << endl;
-
-		if (pAnimation == nullptr) return;
-
-		//cout << "valid animation" << endl;
-
-		//aiMatrix4x4 NodeTransformation(pNode->mTransformation);
-		aiMatrix4x4 NodeTransformation;
-
-		const aiNodeAnim* pNodeAnim = FindNodeAnim(pAnimation, NodeName);
-
-		if (pNodeAnim != nullptr) {
-			aiVector3D Scaling;
-			CalcInterpolatedScaling(Scaling, AnimationTime, pNodeAnim);
-			aiMatrix4x4 ScalingM;
-			if (ScalingM.IsIdentity())
-				aiMatrix4x4::Scaling(Scaling, ScalingM);
-
-			aiQuaternion RotationQ;
-			CalcInterpolatedRotation(RotationQ, AnimationTime, pNodeAnim);
-			aiMatrix4x4 RotationM(RotationQ.GetMatrix());
-
-			aiVector3D Translation;
-			CalcInterpolatedPosition(Translation, AnimationTime, pNodeAnim);
-			aiMatrix4x4 TranslationM;
-			if (ScalingM.IsIdentity())
-				aiMatrix4x4::Translation(Translation, TranslationM);
-
-			// Combine the above transformations
-			NodeTransformation = TranslationM * RotationM * ScalingM;
-
-			// cout << "Compute Node Transformation: " << pNodeAnim->mNodeName.data << endl;
-		}
-
-		glm::mat4 GlobalTransformation = ParentTransform * aiMatrix4x4ToGlm(NodeTransformation);
-
-		//cout << "GT=" << glm::to_string(GlobalTransformation) << endl;
-
-		// cout << "Parent: " << NodeName << endl;
-
-		// Modify bones transformation
-		for (unsigned int b = 0; b < bones.size(); b++) {
-			if (bones[b].name == pNode->mName) {
-				bones[b].transformation = m_GlobalInverseTransform * GlobalTransformation * bones[b].offsetMatrix;
-				//cout << "bone: " << b << " : " << bones[b].name.data << " T= " << glm::to_string(bones[b].transformation) << endl;
-			}
-		}
-
-		for (unsigned int i = 0; i < pNode->mNumChildren; i++) {
-			// cout << "Child: " << pNode->mChildren[i]->mName.data << ": " << i << endl;
-			ReadNodeHierarchy(AnimationTime, pNode->mChildren[i], GlobalTransformation);
-		}
-	}
-
-	const aiNodeAnim* FindNodeAnim(const aiAnimation* pAnimation, const string NodeName)
-	{
-		for (unsigned int i = 0; i < pAnimation->mNumChannels; i++) {
-			const aiNodeAnim* pNodeAnim = pAnimation->mChannels[i];
-
-			if (string(pNodeAnim->mNodeName.data) == NodeName) {
-				return pNodeAnim;
-			}
-		}
-
-		return nullptr;
-	}
-
-
-	void CalcInterpolatedScaling(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		if (pNodeAnim->mNumScalingKeys == 1) {
-			Out = pNodeAnim->mScalingKeys[0].mValue;
-			return;
-		}
-
-		unsigned int ScalingIndex = FindScaling(AnimationTime, pNodeAnim);
-		unsigned int NextScalingIndex = (ScalingIndex + 1);
-		assert(NextScalingIndex < pNodeAnim->mNumScalingKeys);
-		float DeltaTime = (float)(pNodeAnim->mScalingKeys[NextScalingIndex].mTime - pNodeAnim->mScalingKeys[ScalingIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mScalingKeys[ScalingIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiVector3D& Start = pNodeAnim->mScalingKeys[ScalingIndex].mValue;
-		const aiVector3D& End = pNodeAnim->mScalingKeys[NextScalingIndex].mValue;
-		aiVector3D Delta = End - Start;
-		Out = Start + Factor * Delta;
+		pendingTextures.clear();
 	}
 
-	unsigned int FindScaling(float AnimationTime, const aiNodeAnim* pNodeAnim)
+	// Reemplaza el proxy de un mesh por el mesh completo, con todos sus LODs y meshlets
+	// (hilo GL). false si ese mesh ya no es un proxy (p. ej. el modelo se recargo).
+	bool refineMesh(size_t index, const MeshData& mesh)
 	{
-		assert(pNodeAnim->mNumScalingKeys > 0);
-
-		for (unsigned int i = 0; i < pNodeAnim->mNumScalingKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mScalingKeys[i + 1].mTime) {
-				return i;
-			}
-		}
-
-		assert(0);
-
-		return 0;
+		if (index >= meshes.size() || meshes[index].residentLod == 0) return false;
+
+		Mesh full(mesh.geometry(), meshes[index].textures, mesh.submeshes, mesh.lods, mesh.meshlets);
+		full.bounds = mesh.bounds;
+		full.hasSolidColor = meshes[index].hasSolidColor;
+		full.solidColor = meshes[index].solidColor;
+		meshes[index].release();
+		meshes[index] = full;
+		return true;
 	}
 
-	void CalcInterpolatedRotation(aiQuaternion& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
+	bool isFullyResident() const
 	{
-		// we need at least two values to interpolate...
-		if (pNodeAnim->mNumRotationKeys == 1) {
-			Out = pNodeAnim->mRotationKeys[0].mValue;
-			return;
-		}
-
-		unsigned int RotationIndex = FindRotation(AnimationTime, pNodeAnim);
-		unsigned int NextRotationIndex = (RotationIndex + 1);
-		assert(NextRotationIndex < pNodeAnim->mNumRotationKeys);
-		float DeltaTime = (float)(pNodeAnim->mRotationKeys[NextRotationIndex].mTime - pNodeAnim->mRotationKeys[RotationIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mRotationKeys[RotationIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiQuaternion& StartRotationQ = pNodeAnim->mRotationKeys[RotationIndex].mValue;
-		const aiQuaternion& EndRotationQ = pNodeAnim->mRotationKeys[NextRotationIndex].mValue;
-		aiQuaternion::Interpolate(Out, StartRotationQ, EndRotationQ, Factor);
-		Out = Out.Normalize();
+		for (const Mesh& mesh : meshes)
+			if (mesh.residentLod > 0) return false;
+		return true;
 	}
 
-	unsigned int FindRotation(float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		assert(pNodeAnim->mNumRotationKeys > 0);
-
-		for (unsigned int i = 0; i < pNodeAnim->mNumRotationKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mRotationKeys[i + 1].mTime) {
-				return i;
-			}
+	// NUEVO: Obtener material por índice
+	MaterialProperties getMaterial(unsigned int meshIndex) const {
+		if (meshIndex < materials.size()) {
+			return materials[meshIndex];
 		}
-
-		assert(0);
-
-		return 0;
+		// Retornar material por defecto si no existe
+		MaterialProperties defaultMat;
+		defaultMat.ambient = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
+		defaultMat.diffuse = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+		defaultMat.specular = glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);
+		defaultMat.metallic = 0.0f;
+		defaultMat.roughness = 0.5f;
+		defaultMat.ior = 1.45f;
+		defaultMat.alpha = 1.0f;
+		return defaultMat;
 	}
 
-	unsigned int FindPosition(float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		for (unsigned int i = 0; i < pNodeAnim->mNumPositionKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mPositionKeys[i + 1].mTime) {
-				return i;
-			}
-		}
+private:
+	// texturas entregadas por el AssetLoader mientras se construyen los meshes
+	map<string, TextureHandle> pendingTextures;
+	bool keepCollisionGeometry = false;
 
-		assert(0);
 
-		return 0;
-	}
+	/*  Functions   */
 
-	void CalcInterpolatedPosition(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
+	// loads a model from its cooked cache or, if missing/stale, with ASSIMP, and creates the GPU meshes.
+	// La escena de Assimp se libera dentro de loadModelRuntimeData; aqui solo llegan datos propios.
+	void loadModel(string const& path, const ImportOptions& options = ImportOptions())
 	{
-		if (pNodeAnim->mNumPositionKeys == 1) {
-			Out = pNodeAnim->mPositionKeys[0].mValue;
+		ModelData data;
+		if (!loadModelRuntimeData(path, data, options))
 			return;
-		}
 
-		unsigned int PositionIndex = FindPosition(AnimationTime, pNodeAnim);
-		unsigned int NextPositionIndex = (PositionIndex + 1);
-		assert(NextPositionIndex < pNodeAnim->mNumPositionKeys);
-		float DeltaTime = (float)(pNodeAnim->mPositionKeys[NextPositionIndex].mTime - pNodeAnim->mPositionKeys[PositionIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mPositionKeys[PositionIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiVector3D& Start = pNodeAnim->mPositionKeys[PositionIndex].mValue;
-		const aiVector3D& End = pNodeAnim->mPositionKeys[NextPositionIndex].mValue;
-		aiVector3D Delta = End - Start;
-		Out = Start + Factor * Delta;
+		setupModelInfo(data);
+		for (const MeshData& mesh : data.meshes)
+			addMesh(mesh);
+		finishLoading();
 	}
 
-	// checks all material textures of a given type and loads the textures if they're not loaded yet.
+	// resolves the texture references of a mesh and loads the textures if they're not loaded yet.
 	// the required info is returned as a Texture struct.
-	vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName)
+	// Los materiales sin mapa difuso no generan textura: addMesh guarda su color en el Mesh.
+	vector<Texture> loadMaterialTextures(const vector<TextureRef>& refs)
 	{
 		vector<Texture> textures;
-		unsigned int textureCount = mat->GetTextureCount(type);
-
-		// Si no hay texturas de este tipo, intentar usar color del material
-		if (textureCount == 0 && typeName == "texture_diffuse") {
-			aiColor3D color;
-			if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
-				Texture colorTexture;
-				colorTexture.id = createSolidColorTexture(color);
-				colorTexture.type = typeName;
-				colorTexture.path = "procedural_color";
-
-				textures.push_back(colorTexture);
-				textures_loaded.push_back(colorTexture);
-
-				return textures;
-			}
-		}
 
-		for (unsigned int i = 0; i < textureCount; i++)
-		{
-			aiString str;
-			mat->GetTexture(type, i, &str);
-
-			bool skip = false;
-			for (unsigned int j = 0; j < textures_loaded.size(); j++)
-			{
-				if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-				{
-					textures.push_back(textures_loaded[j]);
-					skip = true;
-					break;
-				}
-			}
-			if (!skip)
-			{
-				Texture texture;
-				texture.id = TextureFromFile(str.C_Str(), this->directory);
-				texture.type = typeName;
-				texture.path = str.C_Str();
-				textures.push_back(texture);
-				textures_loaded.push_back(texture);
-			}
-		}
-
-		return textures;
-	}
+		TextureRegistry& registry = TextureRegistry::instance();
 
-	// NUEVO: Crear textura de 1x1 píxel con color sólido
-	unsigned int createSolidColorTexture(const aiColor3D& color) {
-		unsigned int textureID;
-		glGenTextures(1, &textureID);
+		for (const TextureRef& ref : refs)
+		{
+			if (ref.solidColor) continue;
 
-		// Convertir color a bytes (0-255)
-		unsigned char data[4] = {
-			static_cast<unsigned char>(color.r * 255.0f),
-			static_cast<unsigned char>(color.g * 255.0f),
-			static_cast<unsigned char>(color.b * 255.0f),
-			255 // Alpha
-		};
+			Texture texture;
+			texture.type = ref.type;
+			texture.path = ref.path;
 
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			TextureRole role = textureRoleForType(ref.type);
+			auto pending = pendingTextures.find(textureRoleKey(ref.path, role));
+			if (pending != pendingTextures.end())
+				texture.handle = pending->second;
+			else
+				texture.handle = registry.load(this->directory + '/' + ref.path, role);
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			texture.id = texture.handle->id;
+			textures.push_back(texture);
+		}
 
-		return textureID;
+		return textures;
 	}
 };
 
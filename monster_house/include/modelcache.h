@@ -0,0 +1,636 @@
+#ifndef MODELCACHE_H
+#define MODELCACHE_H
+
+#include <modelimporter.h>
+#include <mappedfile.h>
+#include <memoryusage.h>
+#include <skeleton.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+// ============================================================================
+// Cache binario de modelos cocinados (<fuente>.mhc)
+//
+// Disposicion del archivo:
+//   CacheHeader | CacheSection[sectionCount] | secciones alineadas a 16 bytes
+// Los vertices (StaticVertex/SkinnedVertex) e indices (16 o 32 bits) se guardan tal cual
+// se suben a la GPU, de modo que en un acierto de cache el Mesh se crea directamente
+// desde la proyeccion en memoria, sin convertir nada.
+// El cache se invalida si cambia la version, el tamano de los formatos de vertice o el
+// hash del fuente.
+// ============================================================================
+
+#define MODEL_CACHE_MAGIC     0x4D48434Du // "MHCM"
+#define MODEL_CACHE_VERSION   8u // 8: vertices empaquetados e indices de 16 bits
+#define MODEL_CACHE_EXTENSION ".mhc"
+#define MODEL_CACHE_ALIGNMENT 16
+// Tamanos de StaticVertex y SkinnedVertex en CacheHeader::vertexLayout
+#define MODEL_CACHE_VERTEX_LAYOUT ((uint32_t)(sizeof(StaticVertex) | (sizeof(SkinnedVertex) << 16)))
+
+enum CacheSectionType : uint32_t {
+	CACHE_SECTION_INFO = 1,
+	CACHE_SECTION_MESHES,
+	CACHE_SECTION_VERTICES,
+	CACHE_SECTION_INDICES,
+	CACHE_SECTION_MATERIALS,
+	CACHE_SECTION_TEXTURES,
+	CACHE_SECTION_BONES,
+	CACHE_SECTION_NODES,
+	CACHE_SECTION_ANIMATIONS,
+	CACHE_SECTION_CHANNELS,
+	CACHE_SECTION_VECTOR_KEYS,
+	CACHE_SECTION_QUAT_KEYS,
+	CACHE_SECTION_STRINGS,
+	CACHE_SECTION_SUBMESHES,
+	CACHE_SECTION_LODS,
+	CACHE_SECTION_MESHLETS
+};
+
+struct CacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertexLayout;
+	uint32_t sectionCount;
+	uint64_t sourceHash;
+	uint64_t fileSize;
+};
+
+struct CacheSection {
+	uint32_t type;
+	uint32_t count;
+	uint64_t offset;
+	uint64_t size;
+};
+
+struct CachedString {
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct CachedInfo {
+	uint32_t  numBones;
+	uint32_t  padding[3];
+	glm::mat4 globalInverseTransform;
+};
+
+// Los vertices y los indices de cada mesh empiezan en un multiplo de 4 bytes de su seccion
+struct CachedMesh {
+	uint32_t vertexOffset;  // en bytes, dentro de CACHE_SECTION_VERTICES
+	uint32_t numVertices;
+	uint32_t indexOffset;   // en bytes, dentro de CACHE_SECTION_INDICES
+	uint32_t numIndices;
+	uint32_t skinned;       // 1: SkinnedVertex, 0: StaticVertex
+	uint32_t materialIndex;
+	uint32_t firstTexture;
+	uint32_t numTextures;
+	uint32_t firstSubmesh;
+	uint32_t numSubmeshes;
+	uint32_t firstLod;
+	uint32_t numLods;
+	uint32_t firstMeshlet;
+	uint32_t numMeshlets;
+	Bounds   bounds;
+};
+
+struct CachedTexture {
+	CachedString type;
+	CachedString path;
+	uint32_t     solidColor;
+	float        color[3];
+};
+
+struct CachedBone {
+	CachedString name;
+	glm::mat4    offsetMatrix;
+};
+
+struct CachedNode {
+	CachedString name;
+	int32_t      parent;
+	uint32_t     padding;
+	aiMatrix4x4  transformation;
+	Bounds       bounds;
+};
+
+struct CachedAnimation {
+	CachedString name;
+	double       duration;
+	double       ticksPerSecond;
+	uint32_t     firstChannel;
+	uint32_t     numChannels;
+};
+
+struct CachedChannel {
+	CachedString nodeName;
+	uint32_t     firstPositionKey, numPositionKeys;
+	uint32_t     firstRotationKey, numRotationKeys;
+	uint32_t     firstScalingKey, numScalingKeys;
+};
+
+inline string modelCachePath(const string& sourcePath, const ImportOptions& options = ImportOptions())
+{
+	return sourcePath + (options.mergeStaticMeshes ? ".merged" : "") + MODEL_CACHE_EXTENSION;
+}
+
+// Acumula las secciones en memoria y las escribe de una sola vez
+class CacheWriter
+{
+public:
+	template <typename T>
+	void addSection(CacheSectionType type, const vector<T>& items)
+	{
+		addSection(type, (uint32_t)items.size(), items.data(), items.size() * sizeof(T));
+	}
+
+	void addSection(CacheSectionType type, uint32_t count, const void* bytes, size_t size)
+	{
+		PendingSection section;
+		section.type = type;
+		section.count = count;
+		section.bytes.assign((const unsigned char*)bytes, (const unsigned char*)bytes + size);
+		sections.push_back(std::move(section));
+	}
+
+	CachedString addString(const string& str)
+	{
+		CachedString ref;
+		ref.offset = (uint32_t)strings.size();
+		ref.length = (uint32_t)str.size();
+		strings.insert(strings.end(), str.begin(), str.end());
+		return ref;
+	}
+
+	// Escribe a un archivo temporal y lo renombra, para no dejar un cache a medias
+	bool write(const string& path, uint64_t sourceHash)
+	{
+		addSection(CACHE_SECTION_STRINGS, (uint32_t)strings.size(), strings.data(), strings.size());
+
+		CacheHeader header;
+		header.magic = MODEL_CACHE_MAGIC;
+		header.version = MODEL_CACHE_VERSION;
+		header.vertexLayout = MODEL_CACHE_VERTEX_LAYOUT;
+		header.sectionCount = (uint32_t)sections.size();
+		header.sourceHash = sourceHash;
+
+		vector<CacheSection> table(sections.size());
+		uint64_t offset = align(sizeof(CacheHeader) + table.size() * sizeof(CacheSection));
+		for (size_t i = 0; i < sections.size(); i++) {
+			table[i].type = sections[i].type;
+			table[i].count = sections[i].count;
+			table[i].offset = offset;
+			table[i].size = sections[i].bytes.size();
+			offset = align(offset + table[i].size);
+		}
+		header.fileSize = offset;
+
+		string tmpPath = uniqueTempPath(path);
+		FILE* file = fopen(tmpPath.c_str(), "wb");
+		if (!file) return false;
+
+		bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+		ok = ok && (table.empty() || fwrite(table.data(), sizeof(CacheSection), table.size(), file) == table.size());
+		for (size_t i = 0; ok && i < sections.size(); i++) {
+			ok = pad(file, table[i].offset);
+			if (ok && !sections[i].bytes.empty())
+				ok = fwrite(sections[i].bytes.data(), 1, sections[i].bytes.size(), file) == sections[i].bytes.size();
+		}
+		ok = ok && pad(file, header.fileSize);
+		ok = (fclose(file) == 0) && ok;
+
+		if (ok) {
+			remove(path.c_str());
+			ok = rename(tmpPath.c_str(), path.c_str()) == 0;
+		}
+		if (!ok) remove(tmpPath.c_str());
+		return ok;
+	}
+
+private:
+	struct PendingSection {
+		uint32_t type;
+		uint32_t count;
+		vector<unsigned char> bytes;
+	};
+	vector<PendingSection> sections;
+	vector<char> strings;
+
+	static uint64_t align(uint64_t value)
+	{
+		return (value + MODEL_CACHE_ALIGNMENT - 1) & ~(uint64_t)(MODEL_CACHE_ALIGNMENT - 1);
+	}
+
+	static bool pad(FILE* file, uint64_t target)
+	{
+		long position = ftell(file);
+		while (position >= 0 && (uint64_t)position < target) {
+			if (fputc(0, file) == EOF) return false;
+			position++;
+		}
+		return position >= 0;
+	}
+};
+
+// Vista de solo lectura sobre un cache proyectado en memoria
+class CacheReader
+{
+public:
+	explicit CacheReader(const MappedFile& file) : file(file) {}
+
+	bool validate(uint64_t sourceHash)
+	{
+		if (file.getSize() < sizeof(CacheHeader)) return false;
+		header = (const CacheHeader*)file.data();
+		if (header->magic != MODEL_CACHE_MAGIC || header->version != MODEL_CACHE_VERSION) return false;
+		if (header->vertexLayout != MODEL_CACHE_VERTEX_LAYOUT || header->sourceHash != sourceHash) return false;
+		if (header->fileSize != file.getSize()) return false;
+
+		uint64_t tableEnd = sizeof(CacheHeader) + (uint64_t)header->sectionCount * sizeof(CacheSection);
+		if (tableEnd > file.getSize()) return false;
+		table = (const CacheSection*)(file.data() + sizeof(CacheHeader));
+
+		for (uint32_t i = 0; i < header->sectionCount; i++) {
+			if (table[i].offset % MODEL_CACHE_ALIGNMENT != 0) return false;
+			if (table[i].offset + table[i].size > file.getSize()) return false;
+		}
+
+		const CacheSection* stringSection = find(CACHE_SECTION_STRINGS);
+		if (!stringSection) return false;
+		strings = (const char*)(file.data() + stringSection->offset);
+		stringsSize = stringSection->size;
+		return true;
+	}
+
+	// Devuelve el arreglo de la seccion pedida, comprobando que el tamano coincida con el tipo
+	template <typename T>
+	const T* get(CacheSectionType type, uint32_t& count) const
+	{
+		count = 0;
+		const CacheSection* section = find(type);
+		if (!section || section->size != (uint64_t)section->count * sizeof(T)) return nullptr;
+		count = section->count;
+		return (const T*)(file.data() + section->offset);
+	}
+
+	bool getString(const CachedString& ref, string& out) const
+	{
+		if ((uint64_t)ref.offset + ref.length > stringsSize) return false;
+		out.assign(strings + ref.offset, ref.length);
+		return true;
+	}
+
+private:
+	const MappedFile& file;
+	const CacheHeader* header = nullptr;
+	const CacheSection* table = nullptr;
+	const char* strings = nullptr;
+	uint64_t stringsSize = 0;
+
+	const CacheSection* find(CacheSectionType type) const
+	{
+		for (uint32_t i = 0; i < header->sectionCount; i++)
+			if (table[i].type == type) return &table[i];
+		return nullptr;
+	}
+};
+
+inline bool writeModelCache(const string& cachePath, uint64_t sourceHash, const ModelData& data)
+{
+	CacheWriter writer;
+
+	CachedInfo info = {};
+	info.numBones = data.numBones;
+	info.globalInverseTransform = data.globalInverseTransform;
+	writer.addSection(CACHE_SECTION_INFO, 1, &info, sizeof(info));
+
+	vector<CachedMesh> meshes;
+	vector<unsigned char> vertices;
+	vector<unsigned char> indices;
+	vector<CachedTexture> textures;
+	vector<SubMeshRange> submeshes;
+	vector<MeshLod> lods;
+	vector<Meshlet> meshlets;
+	for (const MeshData& mesh : data.meshes) {
+		MeshGeometry geometry = mesh.geometry();
+		CachedMesh record = {};
+		record.vertexOffset = (uint32_t)vertices.size();
+		record.numVertices = (uint32_t)mesh.numVertices;
+		record.indexOffset = (uint32_t)indices.size();
+		record.numIndices = (uint32_t)mesh.numIndices;
+		record.skinned = mesh.skinned ? 1u : 0u;
+		record.materialIndex = mesh.materialIndex;
+		record.firstTexture = (uint32_t)textures.size();
+		record.numTextures = (uint32_t)mesh.textures.size();
+		record.firstSubmesh = (uint32_t)submeshes.size();
+		record.numSubmeshes = (uint32_t)mesh.submeshes.size();
+		record.firstLod = (uint32_t)lods.size();
+		record.numLods = (uint32_t)mesh.lods.size();
+		record.firstMeshlet = (uint32_t)meshlets.size();
+		record.numMeshlets = (uint32_t)mesh.meshlets.size();
+		record.bounds = mesh.bounds;
+		meshes.push_back(record);
+
+		submeshes.insert(submeshes.end(), mesh.submeshes.begin(), mesh.submeshes.end());
+		lods.insert(lods.end(), mesh.lods.begin(), mesh.lods.end());
+		meshlets.insert(meshlets.end(), mesh.meshlets.begin(), mesh.meshlets.end());
+
+		vertices.insert(vertices.end(), geometry.vertices, geometry.vertices + geometry.vertexBytes());
+		indices.insert(indices.end(), geometry.indices, geometry.indices + geometry.indexBytes());
+		// un numero impar de indices de 16 bits dejaria desalineado al mesh siguiente
+		indices.resize((indices.size() + 3) & ~(size_t)3);
+
+		for (const TextureRef& ref : mesh.textures) {
+			CachedTexture texture = {};
+			texture.type = writer.addString(ref.type);
+			texture.path = writer.addString(ref.path);
+			texture.solidColor = ref.solidColor ? 1u : 0u;
+			texture.color[0] = ref.color.r;
+			texture.color[1] = ref.color.g;
+			texture.color[2] = ref.color.b;
+			textures.push_back(texture);
+		}
+	}
+	writer.addSection(CACHE_SECTION_MESHES, meshes);
+	writer.addSection(CACHE_SECTION_VERTICES, vertices);
+	writer.addSection(CACHE_SECTION_INDICES, indices);
+	writer.addSection(CACHE_SECTION_TEXTURES, textures);
+	writer.addSection(CACHE_SECTION_SUBMESHES, submeshes);
+	writer.addSection(CACHE_SECTION_LODS, lods);
+	writer.addSection(CACHE_SECTION_MESHLETS, meshlets);
+	writer.addSection(CACHE_SECTION_MATERIALS, data.materials);
+
+	vector<CachedBone> bones;
+	for (const Bone& bone : data.bones) {
+		CachedBone record;
+		record.name = writer.addString(bone.name.C_Str());
+		record.offsetMatrix = bone.offsetMatrix;
+		bones.push_back(record);
+	}
+	writer.addSection(CACHE_SECTION_BONES, bones);
+
+	vector<CachedNode> nodes;
+	for (const NodeData& node : data.nodes) {
+		CachedNode record = {};
+		record.name = writer.addString(node.name);
+		record.parent = node.parent;
+		record.transformation = node.transformation;
+		record.bounds = node.bounds;
+		nodes.push_back(record);
+	}
+	writer.addSection(CACHE_SECTION_NODES, nodes);
+
+	vector<CachedAnimation> animations;
+	vector<CachedChannel> channels;
+	vector<aiVectorKey> vectorKeys;
+	vector<aiQuatKey> quatKeys;
+	for (const AnimationClip& clip : data.animations) {
+		CachedAnimation record = {};
+		record.name = writer.addString(clip.name);
+		record.duration = clip.duration;
+		record.ticksPerSecond = clip.ticksPerSecond;
+		record.firstChannel = (uint32_t)channels.size();
+		record.numChannels = (uint32_t)clip.channels.size();
+		animations.push_back(record);
+
+		for (const AnimationChannel& channel : clip.channels) {
+			CachedChannel c = {};
+			c.nodeName = writer.addString(channel.nodeName);
+			c.firstPositionKey = (uint32_t)vectorKeys.size();
+			c.numPositionKeys = (uint32_t)channel.positionKeys.size();
+			vectorKeys.insert(vectorKeys.end(), channel.positionKeys.begin(), channel.positionKeys.end());
+			c.firstScalingKey = (uint32_t)vectorKeys.size();
+			c.numScalingKeys = (uint32_t)channel.scalingKeys.size();
+			vectorKeys.insert(vectorKeys.end(), channel.scalingKeys.begin(), channel.scalingKeys.end());
+			c.firstRotationKey = (uint32_t)quatKeys.size();
+			c.numRotationKeys = (uint32_t)channel.rotationKeys.size();
+			quatKeys.insert(quatKeys.end(), channel.rotationKeys.begin(), channel.rotationKeys.end());
+			channels.push_back(c);
+		}
+	}
+	writer.addSection(CACHE_SECTION_ANIMATIONS, animations);
+	writer.addSection(CACHE_SECTION_CHANNELS, channels);
+	writer.addSection(CACHE_SECTION_VECTOR_KEYS, vectorKeys);
+	writer.addSection(CACHE_SECTION_QUAT_KEYS, quatKeys);
+
+	return writer.write(cachePath, sourceHash);
+}
+
+// Lee un cache valido; los meshes quedan apuntando a la proyeccion (sin copiar vertices)
+inline bool parseModelCache(const std::shared_ptr<MappedFile>& file, uint64_t sourceHash, ModelData& data)
+{
+	CacheReader reader(*file);
+	if (!reader.validate(sourceHash)) return false;
+
+	// numVertices y numIndices son los bytes de sus secciones
+	uint32_t numInfo, numMeshes, numVertices, numIndices, numTextures, numMaterials;
+	uint32_t numBones, numNodes, numAnimations, numChannels, numVectorKeys, numQuatKeys, numSubmeshes, numLods, numMeshlets;
+	const CachedInfo* info = reader.get<CachedInfo>(CACHE_SECTION_INFO, numInfo);
+	const CachedMesh* meshes = reader.get<CachedMesh>(CACHE_SECTION_MESHES, numMeshes);
+	const unsigned char* vertices = reader.get<unsigned char>(CACHE_SECTION_VERTICES, numVertices);
+	const unsigned char* indices = reader.get<unsigned char>(CACHE_SECTION_INDICES, numIndices);
+	const CachedTexture* textures = reader.get<CachedTexture>(CACHE_SECTION_TEXTURES, numTextures);
+	const MaterialProperties* materials = reader.get<MaterialProperties>(CACHE_SECTION_MATERIALS, numMaterials);
+	const CachedBone* bones = reader.get<CachedBone>(CACHE_SECTION_BONES, numBones);
+	const CachedNode* nodes = reader.get<CachedNode>(CACHE_SECTION_NODES, numNodes);
+	const CachedAnimation* animations = reader.get<CachedAnimation>(CACHE_SECTION_ANIMATIONS, numAnimations);
+	const CachedChannel* channels = reader.get<CachedChannel>(CACHE_SECTION_CHANNELS, numChannels);
+	const aiVectorKey* vectorKeys = reader.get<aiVectorKey>(CACHE_SECTION_VECTOR_KEYS, numVectorKeys);
+	const aiQuatKey* quatKeys = reader.get<aiQuatKey>(CACHE_SECTION_QUAT_KEYS, numQuatKeys);
+	const SubMeshRange* submeshes = reader.get<SubMeshRange>(CACHE_SECTION_SUBMESHES, numSubmeshes);
+	const MeshLod* lods = reader.get<MeshLod>(CACHE_SECTION_LODS, numLods);
+	const Meshlet* meshlets = reader.get<Meshlet>(CACHE_SECTION_MESHLETS, numMeshlets);
+	if (!info || numInfo != 1) return false;
+
+	ModelData result;
+	result.numBones = info->numBones;
+	result.globalInverseTransform = info->globalInverseTransform;
+
+	for (uint32_t m = 0; m < numMeshes; m++) {
+		const CachedMesh& record = meshes[m];
+		MeshData mesh;
+		mesh.numVertices = record.numVertices;
+		mesh.numIndices = record.numIndices;
+		mesh.skinned = record.skinned != 0;
+		MeshGeometry geometry = mesh.geometry();
+		if (record.vertexOffset % 4 != 0 || record.indexOffset % 4 != 0) return false;
+		if ((uint64_t)record.vertexOffset + geometry.vertexBytes() > numVertices) return false;
+		if ((uint64_t)record.indexOffset + geometry.indexBytes() > numIndices) return false;
+		if ((uint64_t)record.firstTexture + record.numTextures > numTextures) return false;
+		if ((uint64_t)record.firstSubmesh + record.numSubmeshes > numSubmeshes) return false;
+		if ((uint64_t)record.firstLod + record.numLods > numLods) return false;
+		if ((uint64_t)record.firstMeshlet + record.numMeshlets > numMeshlets) return false;
+
+		mesh.mappedVertices = vertices + record.vertexOffset;
+		mesh.mappedIndices = indices + record.indexOffset;
+		mesh.materialIndex = record.materialIndex;
+		mesh.bounds = record.bounds;
+		mesh.submeshes.assign(submeshes + record.firstSubmesh, submeshes + record.firstSubmesh + record.numSubmeshes);
+		mesh.lods.assign(lods + record.firstLod, lods + record.firstLod + record.numLods);
+		for (const MeshLod& lod : mesh.lods)
+			if ((uint64_t)lod.firstIndex + lod.numIndices > record.numIndices) return false;
+		mesh.meshlets.assign(meshlets + record.firstMeshlet, meshlets + record.firstMeshlet + record.numMeshlets);
+		for (const Meshlet& meshlet : mesh.meshlets)
+			if ((uint64_t)meshlet.firstIndex + meshlet.numIndices > record.numIndices) return false;
+		for (uint32_t t = 0; t < record.numTextures; t++) {
+			const CachedTexture& texture = textures[record.firstTexture + t];
+			TextureRef ref;
+			if (!reader.getString(texture.type, ref.type) || !reader.getString(texture.path, ref.path)) return false;
+			ref.solidColor = texture.solidColor != 0;
+			ref.color = glm::vec3(texture.color[0], texture.color[1], texture.color[2]);
+			mesh.textures.push_back(ref);
+		}
+		result.meshes.push_back(std::move(mesh));
+	}
+
+	result.materials.assign(materials, materials + numMaterials);
+
+	for (uint32_t b = 0; b < numBones; b++) {
+		string name;
+		if (!reader.getString(bones[b].name, name)) return false;
+		Bone bone;
+		bone.name = name.c_str();
+		bone.offsetMatrix = bones[b].offsetMatrix;
+		result.bones.push_back(bone);
+	}
+
+	for (uint32_t n = 0; n < numNodes; n++) {
+		NodeData node;
+		if (!reader.getString(nodes[n].name, node.name)) return false;
+		node.parent = nodes[n].parent;
+		node.transformation = nodes[n].transformation;
+		node.bounds = nodes[n].bounds;
+		if (node.parent >= (int)n) return false;
+		if (node.parent >= 0)
+			result.nodes[node.parent].children.push_back(n);
+		result.nodes.push_back(node);
+	}
+
+	for (uint32_t a = 0; a < numAnimations; a++) {
+		const CachedAnimation& record = animations[a];
+		if ((uint64_t)record.firstChannel + record.numChannels > numChannels) return false;
+
+		AnimationClip clip;
+		if (!reader.getString(record.name, clip.name)) return false;
+		clip.duration = record.duration;
+		clip.ticksPerSecond = record.ticksPerSecond;
+		for (uint32_t c = 0; c < record.numChannels; c++) {
+			const CachedChannel& cached = channels[record.firstChannel + c];
+			if ((uint64_t)cached.firstPositionKey + cached.numPositionKeys > numVectorKeys) return false;
+			if ((uint64_t)cached.firstScalingKey + cached.numScalingKeys > numVectorKeys) return false;
+			if ((uint64_t)cached.firstRotationKey + cached.numRotationKeys > numQuatKeys) return false;
+
+			AnimationChannel channel;
+			if (!reader.getString(cached.nodeName, channel.nodeName)) return false;
+			channel.positionKeys.assign(vectorKeys + cached.firstPositionKey, vectorKeys + cached.firstPositionKey + cached.numPositionKeys);
+			channel.scalingKeys.assign(vectorKeys + cached.firstScalingKey, vectorKeys + cached.firstScalingKey + cached.numScalingKeys);
+			channel.rotationKeys.assign(quatKeys + cached.firstRotationKey, quatKeys + cached.firstRotationKey + cached.numRotationKeys);
+			clip.channels.push_back(std::move(channel));
+		}
+		result.animations.push_back(std::move(clip));
+	}
+
+	computeModelBounds(result);
+	result.path = data.path;
+	result.directory = data.directory;
+	result.backing = file;
+	data = std::move(result);
+	return true;
+}
+
+// Primero la copia del pack montado; si quedo vieja respecto a la fuente, la suelta en disco
+inline bool readModelCache(const string& cachePath, uint64_t sourceHash, ModelData& data)
+{
+	std::shared_ptr<MappedFile> packed = AssetPack::instance().open(cachePath);
+	if (packed && parseModelCache(packed, sourceHash, data)) return true;
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	return file->open(cachePath) && parseModelCache(file, sourceHash, data);
+}
+
+// Bytes de CPU que el modelo conserva despues de subir sus meshes: jerarquia, clips
+// (sin claves), skeleton compilado con sus pistas, huesos, materiales y la geometria
+// de colision opcional
+inline size_t modelRuntimeBytes(const ModelData& data)
+{
+	size_t bytes = data.materials.size() * sizeof(MaterialProperties) + data.bones.size() * sizeof(Bone);
+	for (const NodeData& node : data.nodes)
+		bytes += sizeof(NodeData) + node.name.capacity() + node.children.size() * sizeof(unsigned int);
+	for (const AnimationClip& clip : data.animations)
+		bytes += sizeof(AnimationClip) + clip.name.capacity();
+	bytes += CompiledSkeleton::compiledBytes(data.nodes, data.bones, data.animations);
+	if (data.options.keepCollisionGeometry)
+		for (const MeshData& mesh : data.meshes)
+			bytes += mesh.numVertices * sizeof(glm::vec3) + mesh.numIndices * sizeof(unsigned int);
+	return bytes;
+}
+
+// Bytes de la escena de Assimp que FreeScene devuelve: los arreglos de cada mesh
+// (vertices, canales de atributos, caras, huesos y pesos) y las claves de cada clip
+inline size_t assimpSceneBytes(const aiScene* scene)
+{
+	size_t bytes = 0;
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+		const aiMesh* mesh = scene->mMeshes[m];
+		size_t vectors = (mesh->HasPositions() ? 1 : 0) + (mesh->HasNormals() ? 1 : 0) + (mesh->HasTangentsAndBitangents() ? 2 : 0);
+		for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; c++)
+			if (mesh->HasTextureCoords(c)) vectors++;
+		bytes += sizeof(aiMesh) + vectors * mesh->mNumVertices * sizeof(aiVector3D);
+		for (unsigned int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; c++)
+			if (mesh->HasVertexColors(c)) bytes += mesh->mNumVertices * sizeof(aiColor4D);
+		for (unsigned int f = 0; f < mesh->mNumFaces; f++)
+			bytes += sizeof(aiFace) + mesh->mFaces[f].mNumIndices * sizeof(unsigned int);
+		for (unsigned int b = 0; b < mesh->mNumBones; b++)
+			bytes += sizeof(aiBone) + mesh->mBones[b]->mNumWeights * sizeof(aiVertexWeight);
+	}
+	for (unsigned int a = 0; a < scene->mNumAnimations; a++) {
+		const aiAnimation* animation = scene->mAnimations[a];
+		bytes += sizeof(aiAnimation);
+		for (unsigned int c = 0; c < animation->mNumChannels; c++) {
+			const aiNodeAnim* channel = animation->mChannels[c];
+			bytes += sizeof(aiNodeAnim) + (channel->mNumPositionKeys + channel->mNumScalingKeys) * sizeof(aiVectorKey) +
+				channel->mNumRotationKeys * sizeof(aiQuatKey);
+		}
+	}
+	return bytes;
+}
+
+// Carga el modelo cocinado si esta al dia; si no, lo importa con Assimp y reescribe el
+// cache. El importador (y con el toda la escena importada) solo existe en ese caso y se
+// libera antes de volver, asi que los modelos cocinados nunca lo construyen. Reporta lo
+// que ocupaba la escena junto a lo que el modelo conserva en CPU.
+inline bool loadModelRuntimeData(const string& path, ModelData& data, const ImportOptions& options = ImportOptions())
+{
+	data.path = path;
+	data.directory = path.substr(0, path.find_last_of('/'));
+
+	string cachePath = modelCachePath(path, options);
+	uint64_t sourceHash = cookedSourceHash(path, cachePath);
+
+	if (sourceHash != 0 && readModelCache(cachePath, sourceHash, data)) {
+		cout << "Model cache hit: " << cachePath << endl;
+		data.options = options;
+		printModelMemoryReport(path, 0, modelRuntimeBytes(data));
+		return true;
+	}
+#if COOKED_ASSETS_ONLY
+	cout << "ERROR::MODEL_CACHE:: missing or stale cooked model " << cachePath << endl;
+	return false;
+#else
+	size_t sceneBytes;
+	{
+		Assimp::Importer importer;
+		if (!importModel(importer, path, data, options))
+			return false;
+		sceneBytes = assimpSceneBytes(importer.GetScene());
+	}
+	data.options = options;
+
+	if (sourceHash != 0 && !writeModelCache(cachePath, sourceHash, data))
+		cout << "WARNING::MODEL_CACHE:: could not write " << cachePath << endl;
+
+	printModelMemoryReport(path, sceneBytes, modelRuntimeBytes(data));
+	return true;
+#endif
+}
+
+#endif
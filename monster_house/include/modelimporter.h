@@ -0,0 +1,761 @@
+#ifndef MODELIMPORTER_H
+#define MODELIMPORTER_H
+
+#include <modelstructs.h>
+#include <mappedfile.h>
+#include <meshprocessing.h>
+#include <meshsimplify.h>
+#include <meshlets.h>
+#include <bounds.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+// Referencia a una textura del material; se resuelve a un objeto GL al construir el modelo
+struct TextureRef {
+	string    type;
+	string    path;
+	bool      solidColor = false; // material sin mapa difuso: usar su color
+	glm::vec3 color = glm::vec3(0.0f);
+};
+
+// Datos de CPU de un mesh. Durante la importacion se trabaja con Vertex e indices de 32
+// bits; al terminar, packMeshData() los pasa al formato de la GPU (ver MeshGeometry), que
+// vive en los vectores propios o apunta directamente a un archivo cocinado proyectado.
+struct MeshData {
+	vector<Vertex>        vertexStorage;     // solo durante la importacion
+	vector<unsigned int>  indexStorage;      // solo durante la importacion
+	vector<unsigned char> packedVertices;
+	vector<unsigned char> packedIndices;
+	const unsigned char*  mappedVertices = nullptr;
+	const unsigned char*  mappedIndices = nullptr;
+	size_t                numVertices = 0;
+	size_t                numIndices = 0;
+	bool                  skinned = false;   // SkinnedVertex en vez de StaticVertex
+
+	unsigned int         materialIndex = 0;
+	vector<TextureRef>   textures;
+	vector<SubMeshRange> submeshes;         // vacio salvo en meshes combinados
+	vector<MeshLod>      lods;              // vacio si el mesh tiene un solo nivel
+	vector<Meshlet>      meshlets;          // grupos de triangulos del nivel 0 para descartar por partes
+	Bounds               bounds = Bounds::empty(); // en el espacio del mesh (el que se dibuja)
+
+	// solo durante la importacion (no se guardan en el cache)
+	int                  node = -1;         // nodo de la jerarquia que lo instancia
+	bool                 mergeable = false; // lista de triangulos sin huesos (tambien admite LODs)
+
+	MeshGeometry geometry() const
+	{
+		MeshGeometry result;
+		result.vertices = mappedVertices ? mappedVertices : packedVertices.data();
+		result.numVertices = numVertices;
+		result.indices = mappedIndices ? mappedIndices : packedIndices.data();
+		result.numIndices = numIndices;
+		result.skinned = skinned;
+		return result;
+	}
+	// indices del nivel 0; los de los LODs van a continuacion
+	size_t baseIndexCount() const { return lods.empty() ? numIndices : lods[0].numIndices; }
+};
+
+// Opciones de importacion; cada combinacion tiene su propio archivo cocinado
+struct ImportOptions {
+	// Hornea las transformaciones de nodo y junta los meshes estaticos que comparten
+	// material en un solo buffer (un draw call por material)
+	bool mergeStaticMeshes = false;
+	// Conserva en CPU posiciones e indices de cada mesh para colisiones/picking
+	// (no cambia el archivo cocinado)
+	bool keepCollisionGeometry = false;
+};
+
+// Geometria de colision: solo lo necesario para consultas en CPU
+struct CollisionMesh {
+	vector<glm::vec3>    positions;
+	vector<unsigned int> indices;
+};
+
+// Nodo de la jerarquia en un arreglo plano (preorden: el padre siempre precede a sus hijos)
+struct NodeData {
+	string               name;
+	int                  parent = -1;
+	vector<unsigned int> children;
+	aiMatrix4x4          transformation;
+	Bounds               bounds = Bounds::empty(); // meshes del nodo y de sus hijos, en el espacio del nodo
+};
+
+// Canal de animacion de un nodo, independiente de la escena de Assimp
+struct AnimationChannel {
+	string              nodeName;
+	vector<aiVectorKey> positionKeys;
+	vector<aiQuatKey>   rotationKeys;
+	vector<aiVectorKey> scalingKeys;
+};
+
+struct AnimationClip {
+	string                   name;
+	double                   duration = 0.0;
+	double                   ticksPerSecond = 0.0;
+	vector<AnimationChannel> channels;
+};
+
+// Con 1 la importacion reporta cada mesh (pesos, optimizacion, LODs, meshlets). Los
+// modelos se importan en los hilos del AssetLoader, asi que esas lineas salen
+// entremezcladas; con 0 cada modelo deja solo su resumen (ver ImportStats).
+#ifndef MODEL_IMPORT_VERBOSE
+#define MODEL_IMPORT_VERBOSE 0
+#endif
+
+// Totales de una importacion, para una sola linea de resumen por modelo
+struct ImportStats {
+	size_t importedMeshes = 0;
+	size_t skinWeights = 0;
+	double skinMillis = 0.0;
+	size_t verticesBefore = 0;
+	size_t verticesAfter = 0;
+	double cacheMissesBefore = 0.0; // ACMR * triangulos, para promediar por triangulo
+	double cacheMissesAfter = 0.0;
+	size_t optimizedTriangles = 0;
+	size_t bytesBefore = 0;         // Vertex e indices de 32 bits
+	size_t bytesAfter = 0;          // formato de la GPU
+	size_t lodMeshes = 0;
+	size_t lodLevels = 0;
+	double lodMillis = 0.0;
+	size_t meshlets = 0;
+};
+
+// Todo lo que se necesita para construir un Model/AnimatedModel sin volver a consultar Assimp
+struct ModelData {
+	string                     path;
+	string                     directory;
+	vector<MeshData>           meshes;
+	vector<MaterialProperties> materials;
+	vector<Bone>               bones;
+	unsigned int               numBones = 0;
+	vector<NodeData>           nodes;
+	vector<AnimationClip>      animations;
+	glm::mat4                  globalInverseTransform = glm::mat4(1.0f);
+	Bounds                     bounds = Bounds::empty(); // union de los meshes tal como se dibujan
+	ImportOptions              options;
+	ImportStats                importStats; // solo durante la importacion
+
+	// Mantiene viva la proyeccion del archivo cocinado mientras haya meshes apuntando a ella
+	std::shared_ptr<MappedFile> backing;
+};
+
+// Version provisional de un mesh para la carga progresiva: solo su LOD mas simple, con
+// los vertices que ese nivel usa compactados en un buffer propio (formato de la GPU)
+struct MeshProxy {
+	vector<unsigned char> vertices;
+	vector<unsigned char> indices;
+	size_t                numVertices = 0;
+	size_t                numIndices = 0;
+	bool                  skinned = false;
+	unsigned int          lod = 0; // nivel que representa
+
+	MeshGeometry geometry() const
+	{
+		MeshGeometry result;
+		result.vertices = vertices.data();
+		result.numVertices = numVertices;
+		result.indices = indices.data();
+		result.numIndices = numIndices;
+		result.skinned = skinned;
+		return result;
+	}
+};
+
+// Arma el proxy desde el ultimo LOD (CPU; seguro en hilos de trabajo). Solo lee las
+// paginas del cache que ese nivel toca. false si el mesh no tiene LODs.
+inline bool buildMeshProxy(const MeshData& mesh, MeshProxy& proxy)
+{
+	if (mesh.lods.size() < 2) return false;
+
+	proxy.lod = (unsigned int)mesh.lods.size() - 1;
+	const MeshLod& range = mesh.lods.back();
+	MeshGeometry source = mesh.geometry();
+	size_t stride = source.vertexStride();
+
+	vector<unsigned int> remap(mesh.numVertices, ~0u);
+	vector<unsigned int> indices(range.numIndices);
+	proxy.vertices.clear();
+	proxy.numVertices = 0;
+	for (uint32_t i = 0; i < range.numIndices; i++) {
+		unsigned int original = source.index(range.firstIndex + i);
+		unsigned int& slot = remap[original];
+		if (slot == ~0u) {
+			slot = (unsigned int)proxy.numVertices++;
+			const unsigned char* vertex = source.vertices + original * stride;
+			proxy.vertices.insert(proxy.vertices.end(), vertex, vertex + stride);
+		}
+		indices[i] = slot;
+	}
+	proxy.skinned = source.skinned;
+	proxy.numIndices = indices.size();
+	packIndices(indices.data(), indices.size(), proxy.numVertices, proxy.indices);
+	return true;
+}
+
+inline glm::mat4 aiToGlm(const aiMatrix4x4& from)
+{
+	glm::mat4 to;
+
+	to[0][0] = (GLfloat)from.a1; to[0][1] = (GLfloat)from.b1;  to[0][2] = (GLfloat)from.c1; to[0][3] = (GLfloat)from.d1;
+	to[1][0] = (GLfloat)from.a2; to[1][1] = (GLfloat)from.b2;  to[1][2] = (GLfloat)from.c2; to[1][3] = (GLfloat)from.d2;
+	to[2][0] = (GLfloat)from.a3; to[2][1] = (GLfloat)from.b3;  to[2][2] = (GLfloat)from.c3; to[2][3] = (GLfloat)from.d3;
+	to[3][0] = (GLfloat)from.a4; to[3][1] = (GLfloat)from.b4;  to[3][2] = (GLfloat)from.c4; to[3][3] = (GLfloat)from.d4;
+
+	return to;
+}
+
+// Cargar propiedades de materiales desde Assimp
+inline void importMaterials(const aiScene* scene, ModelData& data)
+{
+	data.materials.clear();
+
+	for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+		aiMaterial* mat = scene->mMaterials[i];
+		MaterialProperties matProps;
+
+		// Cargar colores
+		aiColor3D color;
+		if (mat->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS)
+			matProps.ambient = glm::vec4(color.r, color.g, color.b, 1.0f);
+		else
+			matProps.ambient = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
+
+		if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS)
+			matProps.diffuse = glm::vec4(color.r, color.g, color.b, 1.0f);
+		else
+			matProps.diffuse = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+
+		if (mat->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS)
+			matProps.specular = glm::vec4(color.r, color.g, color.b, 1.0f);
+		else
+			matProps.specular = glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);
+
+		// Cargar propiedades PBR
+		float value;
+		matProps.metallic = (mat->Get(AI_MATKEY_METALLIC_FACTOR, value) == AI_SUCCESS) ? value : 0.0f;
+		matProps.roughness = (mat->Get(AI_MATKEY_ROUGHNESS_FACTOR, value) == AI_SUCCESS) ? value : 0.5f;
+		matProps.ior = (mat->Get(AI_MATKEY_REFRACTI, value) == AI_SUCCESS) ? value : 1.45f;
+
+		// Cargar transparencia (Alpha)
+		matProps.alpha = (mat->Get(AI_MATKEY_OPACITY, value) == AI_SUCCESS) ? value : 1.0f;
+
+		data.materials.push_back(matProps);
+	}
+}
+
+// Registra las texturas de un tipo; si el material no tiene mapa difuso se guarda su color
+inline void importMaterialTextures(aiMaterial* mat, aiTextureType type, const string& typeName, vector<TextureRef>& textures)
+{
+	unsigned int textureCount = mat->GetTextureCount(type);
+
+	if (textureCount == 0 && typeName == "texture_diffuse") {
+		aiColor3D color;
+		if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
+			TextureRef ref;
+			ref.type = typeName;
+			ref.path = "procedural_color";
+			ref.solidColor = true;
+			ref.color = glm::vec3(color.r, color.g, color.b);
+			textures.push_back(ref);
+		}
+		return;
+	}
+
+	for (unsigned int i = 0; i < textureCount; i++) {
+		aiString str;
+		mat->GetTexture(type, i, &str);
+
+		TextureRef ref;
+		ref.type = typeName;
+		ref.path = str.C_Str();
+		textures.push_back(ref);
+	}
+}
+
+// Influencias de hueso por vertice que caben en IDs1..IDs3 / Weights1..Weights3
+#define MAX_SKIN_INFLUENCES (3 * MAX_NUM_BONES)
+
+// Reparte los pesos de todos los huesos en sus vertices con una sola pasada sobre
+// aiBone::mWeights (O(pesos) en vez de O(vertices x pesos)). Cada vertice conserva
+// las MAX_SKIN_INFLUENCES influencias mas fuertes ordenadas de mayor a menor y
+// renormalizadas para que sumen 1. Devuelve el total de pesos leidos.
+inline size_t gatherSkinWeights(const aiMesh* mesh, vector<Vertex>& vertices)
+{
+	size_t numVertices = vertices.size();
+	vector<float>         slotWeights(numVertices * MAX_SKIN_INFLUENCES, 0.0f);
+	vector<unsigned int>  slotBones(numVertices * MAX_SKIN_INFLUENCES, 0);
+	vector<unsigned char> slotCount(numVertices, 0);
+	size_t totalWeights = 0;
+
+	for (unsigned int b = 0; b < mesh->mNumBones; b++) {
+		const aiBone* bone = mesh->mBones[b];
+		totalWeights += bone->mNumWeights;
+		for (unsigned int k = 0; k < bone->mNumWeights; k++) {
+			unsigned int vertexId = bone->mWeights[k].mVertexId;
+			float weight = (float)bone->mWeights[k].mWeight;
+			if (vertexId >= numVertices || weight <= 0.0f) continue;
+
+			float* weights = &slotWeights[vertexId * MAX_SKIN_INFLUENCES];
+			unsigned int* bones = &slotBones[vertexId * MAX_SKIN_INFLUENCES];
+			unsigned int count = slotCount[vertexId];
+
+			// insercion ordenada; si ya esta lleno se descarta la influencia mas debil
+			if (count == MAX_SKIN_INFLUENCES) {
+				if (weight <= weights[count - 1]) continue;
+				count--;
+			}
+			unsigned int pos = count;
+			while (pos > 0 && weights[pos - 1] < weight) {
+				weights[pos] = weights[pos - 1];
+				bones[pos] = bones[pos - 1];
+				pos--;
+			}
+			weights[pos] = weight;
+			bones[pos] = b;
+			slotCount[vertexId] = (unsigned char)(count + 1);
+		}
+	}
+
+	for (size_t v = 0; v < numVertices; v++) {
+		const float* weights = &slotWeights[v * MAX_SKIN_INFLUENCES];
+		const unsigned int* bones = &slotBones[v * MAX_SKIN_INFLUENCES];
+		unsigned int count = slotCount[v];
+
+		float sum = 0.0f;
+		for (unsigned int s = 0; s < count; s++)
+			sum += weights[s];
+		float scale = sum > 0.0f ? 1.0f / sum : 0.0f;
+
+		Vertex& vertex = vertices[v];
+		glm::vec4* ids[3] = { &vertex.IDs1, &vertex.IDs2, &vertex.IDs3 };
+		glm::vec4* packed[3] = { &vertex.Weights1, &vertex.Weights2, &vertex.Weights3 };
+		for (unsigned int s = 0; s < count; s++) {
+			(*ids[s / MAX_NUM_BONES])[s % MAX_NUM_BONES] = (float)bones[s];
+			(*packed[s / MAX_NUM_BONES])[s % MAX_NUM_BONES] = weights[s] * scale;
+		}
+	}
+
+	return totalWeights;
+}
+
+inline void importMesh(aiMesh* mesh, const aiScene* scene, ModelData& data, int node = -1)
+{
+	MeshData meshData;
+	meshData.node = node;
+	vector<Vertex>& vertices = meshData.vertexStorage;
+	vector<unsigned int>& indices = meshData.indexStorage;
+	vertices.reserve(mesh->mNumVertices);
+
+	// Walk through each of the mesh's vertices
+	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+	{
+		Vertex vertex;
+		glm::vec3 vector;
+
+		// positions
+		vector.x = mesh->mVertices[i].x;
+		vector.y = mesh->mVertices[i].y;
+		vector.z = mesh->mVertices[i].z;
+		vertex.Position = vector;
+
+		// normals
+		vector.x = mesh->mNormals[i].x;
+		vector.y = mesh->mNormals[i].y;
+		vector.z = mesh->mNormals[i].z;
+		vertex.Normal = vector;
+
+		// texture coordinates
+		if (mesh->mTextureCoords[0])
+		{
+			glm::vec2 vec;
+			vec.x = mesh->mTextureCoords[0][i].x;
+			vec.y = mesh->mTextureCoords[0][i].y;
+			vertex.TexCoords = vec;
+		}
+		else
+			vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+
+		// tangent
+		vector.x = mesh->mTangents[i].x;
+		vector.y = mesh->mTangents[i].y;
+		vector.z = mesh->mTangents[i].z;
+		vertex.Tangent = vector;
+
+		// bitangent
+		vector.x = mesh->mBitangents[i].x;
+		vector.y = mesh->mBitangents[i].y;
+		vector.z = mesh->mBitangents[i].z;
+		vertex.Bitangent = vector;
+
+		// Bones (se llenan despues en una sola pasada)
+		vertex.IDs1 = vertex.IDs2 = vertex.IDs3 = glm::vec4(0.0f);
+		vertex.Weights1 = vertex.Weights2 = vertex.Weights3 = glm::vec4(0.0f);
+		vertices.push_back(vertex);
+	}
+
+	if (mesh->mNumBones > 0) {
+		auto skinStart = std::chrono::steady_clock::now();
+		size_t totalWeights = gatherSkinWeights(mesh, vertices);
+		std::chrono::duration<double, std::milli> skinTime = std::chrono::steady_clock::now() - skinStart;
+		data.importStats.skinWeights += totalWeights;
+		data.importStats.skinMillis += skinTime.count();
+		if (MODEL_IMPORT_VERBOSE)
+			cout << "Skin weights: " << vertices.size() << " vertices, " << totalWeights << " weights, "
+				<< mesh->mNumBones << " bones in " << skinTime.count() << " ms" << endl;
+	}
+	// Process faces
+	bool triangles = true;
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	{
+		aiFace face = mesh->mFaces[i];
+		triangles = triangles && face.mNumIndices == 3;
+		for (unsigned int j = 0; j < face.mNumIndices; j++)
+			indices.push_back(face.mIndices[j]);
+	}
+
+	// Optimizacion: soldar vertices, ordenar para la cache de vertices y el overdraw
+	// (solo listas de triangulos; puntos y lineas se dejan como vienen)
+	if (triangles && !indices.empty()) {
+		size_t originalVertices = vertices.size();
+		float acmrBefore = computeACMR(indices, vertices.size());
+
+		// los pesos ya estan en los vertices, asi que no hay que remapear nada mas
+		weldVertices(vertices, indices);
+		optimizeVertexCache(indices, vertices.size());
+		optimizeOverdraw(indices, vertices);
+		optimizeVertexFetch(vertices, indices);
+
+		float acmrAfter = computeACMR(indices, vertices.size());
+		size_t vertexSize = hasSkinWeights(vertices.data(), vertices.size()) ? sizeof(SkinnedVertex) : sizeof(StaticVertex);
+		size_t bytesBefore = originalVertices * sizeof(Vertex) + indices.size() * sizeof(unsigned int);
+		size_t bytesAfter = vertices.size() * vertexSize +
+			indices.size() * (useShortIndices(vertices.size()) ? sizeof(unsigned short) : sizeof(unsigned int));
+
+		ImportStats& stats = data.importStats;
+		size_t triangleCount = indices.size() / 3;
+		stats.verticesBefore += originalVertices;
+		stats.verticesAfter += vertices.size();
+		stats.cacheMissesBefore += acmrBefore * triangleCount;
+		stats.cacheMissesAfter += acmrAfter * triangleCount;
+		stats.optimizedTriangles += triangleCount;
+		stats.bytesBefore += bytesBefore;
+		stats.bytesAfter += bytesAfter;
+		if (MODEL_IMPORT_VERBOSE)
+			cout << "Mesh optimized: " << mesh->mName.C_Str() << " vertices " << originalVertices << " -> " << vertices.size()
+				<< ", ACMR " << acmrBefore << " -> " << acmrAfter
+				<< ", " << bytesBefore / 1024 << " KB -> " << bytesAfter / 1024 << " KB" << endl;
+	}
+
+	meshData.mergeable = triangles && mesh->mNumBones == 0;
+	data.numBones = mesh->mNumBones;
+
+	// Process Bones
+	data.bones.clear();
+	for (unsigned int i = 0; i < mesh->mNumBones; i++) {
+		Bone  newBone;
+		newBone.name = mesh->mBones[i]->mName;
+		newBone.offsetMatrix = aiToGlm(mesh->mBones[i]->mOffsetMatrix);
+		newBone.transformation = glm::mat4(1.0f);
+
+		data.bones.push_back(newBone);
+	}
+
+	meshData.numVertices = vertices.size();
+	meshData.numIndices = indices.size();
+	if (!vertices.empty())
+		meshData.bounds = Bounds::fromPoints(&vertices[0].Position, vertices.size(), sizeof(Vertex));
+
+	// process materials
+	meshData.materialIndex = mesh->mMaterialIndex;
+	aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+
+	// 1. diffuse maps
+	importMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", meshData.textures);
+	// 2. specular maps
+	importMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", meshData.textures);
+	// 3. normal maps
+	importMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", meshData.textures);
+	// 4. height maps
+	importMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", meshData.textures);
+
+	data.meshes.push_back(std::move(meshData));
+	data.importStats.importedMeshes++;
+}
+
+// Recorre la jerarquia en preorden: guarda cada nodo en el arreglo plano e importa sus meshes
+inline void importNode(aiNode* node, int parent, const aiScene* scene, ModelData& data)
+{
+	unsigned int index = (unsigned int)data.nodes.size();
+	NodeData nodeData;
+	nodeData.name = node->mName.C_Str();
+	nodeData.parent = parent;
+	nodeData.transformation = node->mTransformation;
+	data.nodes.push_back(nodeData);
+	if (parent >= 0)
+		data.nodes[parent].children.push_back(index);
+
+	for (unsigned int i = 0; i < node->mNumMeshes; i++)
+		importMesh(scene->mMeshes[node->mMeshes[i]], scene, data, (int)index);
+
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
+		importNode(node->mChildren[i], (int)index, scene, data);
+}
+
+inline void importAnimations(const aiScene* scene, ModelData& data)
+{
+	data.animations.clear();
+
+	for (unsigned int a = 0; a < scene->mNumAnimations; a++) {
+		const aiAnimation* pAnimation = scene->mAnimations[a];
+		AnimationClip clip;
+		clip.name = pAnimation->mName.C_Str();
+		clip.duration = pAnimation->mDuration;
+		clip.ticksPerSecond = pAnimation->mTicksPerSecond;
+
+		for (unsigned int c = 0; c < pAnimation->mNumChannels; c++) {
+			const aiNodeAnim* pNodeAnim = pAnimation->mChannels[c];
+			AnimationChannel channel;
+			channel.nodeName = pNodeAnim->mNodeName.C_Str();
+			channel.positionKeys.assign(pNodeAnim->mPositionKeys, pNodeAnim->mPositionKeys + pNodeAnim->mNumPositionKeys);
+			channel.rotationKeys.assign(pNodeAnim->mRotationKeys, pNodeAnim->mRotationKeys + pNodeAnim->mNumRotationKeys);
+			channel.scalingKeys.assign(pNodeAnim->mScalingKeys, pNodeAnim->mScalingKeys + pNodeAnim->mNumScalingKeys);
+			clip.channels.push_back(std::move(channel));
+		}
+
+		data.animations.push_back(std::move(clip));
+	}
+}
+
+// Importa un archivo con Assimp y extrae toda la informacion a un ModelData
+// Clave de agrupacion: mismo material y mismas texturas
+inline string meshMaterialKey(const MeshData& mesh)
+{
+	string key = to_string(mesh.materialIndex);
+	for (const TextureRef& ref : mesh.textures) {
+		key += '|' + ref.type + ':' + ref.path;
+		if (ref.solidColor)
+			key += ':' + to_string(ref.color.r) + ',' + to_string(ref.color.g) + ',' + to_string(ref.color.b);
+	}
+	return key;
+}
+
+// Junta los meshes estaticos por material. Las transformaciones de nodo se hornean en
+// los vertices, excepto la del nodo raiz (el modelo nunca la ha aplicado; suele ser la
+// conversion de ejes del exportador). Cada mesh original queda como un SubMeshRange.
+inline void mergeStaticMeshes(ModelData& data)
+{
+	vector<glm::mat4> global(data.nodes.size(), glm::mat4(1.0f));
+	for (size_t n = 0; n < data.nodes.size(); n++) {
+		int parent = data.nodes[n].parent;
+		if (parent >= 0)
+			global[n] = global[parent] * aiToGlm(data.nodes[n].transformation);
+	}
+
+	vector<MeshData> result;
+	map<string, size_t> groups;
+	size_t originalCount = data.meshes.size();
+
+	for (MeshData& mesh : data.meshes) {
+		if (!mesh.mergeable || mesh.numVertices == 0) {
+			result.push_back(std::move(mesh));
+			continue;
+		}
+
+		string key = meshMaterialKey(mesh);
+		auto group = groups.find(key);
+		if (group == groups.end()) {
+			MeshData merged;
+			merged.mergeable = true;
+			merged.materialIndex = mesh.materialIndex;
+			merged.textures = mesh.textures;
+			group = groups.insert(make_pair(key, result.size())).first;
+			result.push_back(std::move(merged));
+		}
+		MeshData& merged = result[group->second];
+
+		glm::mat4 transform = mesh.node >= 0 ? global[mesh.node] : glm::mat4(1.0f);
+		glm::mat3 basis(transform);
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(basis));
+
+		SubMeshRange range;
+		range.firstIndex = (uint32_t)merged.indexStorage.size();
+		range.numIndices = (uint32_t)mesh.numIndices;
+		range.firstVertex = (uint32_t)merged.vertexStorage.size();
+		range.numVertices = (uint32_t)mesh.numVertices;
+		merged.submeshes.push_back(range);
+
+		const Vertex* vertices = mesh.vertexStorage.data();
+		for (size_t v = 0; v < mesh.numVertices; v++) {
+			Vertex vertex = vertices[v];
+			vertex.Position = glm::vec3(transform * glm::vec4(vertex.Position, 1.0f));
+			vertex.Normal = glm::normalize(normalMatrix * vertex.Normal);
+			vertex.Tangent = glm::normalize(basis * vertex.Tangent);
+			vertex.Bitangent = glm::normalize(basis * vertex.Bitangent);
+			merged.vertexStorage.push_back(vertex);
+		}
+		const unsigned int* indices = mesh.indexStorage.data();
+		for (size_t i = 0; i < mesh.numIndices; i++)
+			merged.indexStorage.push_back(indices[i] + range.firstVertex);
+	}
+
+	for (MeshData& mesh : result) {
+		if (mesh.submeshes.empty()) continue;
+		mesh.numVertices = mesh.vertexStorage.size();
+		mesh.numIndices = mesh.indexStorage.size();
+		mesh.bounds = Bounds::fromPoints(&mesh.vertexStorage[0].Position, mesh.numVertices, sizeof(Vertex));
+	}
+
+	if (MODEL_IMPORT_VERBOSE)
+		cout << "Merged " << originalCount << " meshes into " << result.size() << " (by material)" << endl;
+	data.meshes.swap(result);
+}
+
+// Volumen de cada nodo: sus meshes mas los de sus hijos llevados a su espacio. Los nodos
+// estan en preorden, asi que recorriendo al reves cada hijo se resuelve antes que su padre.
+inline void computeNodeBounds(ModelData& data)
+{
+	for (NodeData& node : data.nodes)
+		node.bounds = Bounds::empty();
+	for (const MeshData& mesh : data.meshes)
+		if (mesh.node >= 0 && mesh.node < (int)data.nodes.size())
+			data.nodes[mesh.node].bounds.merge(mesh.bounds);
+
+	for (size_t n = data.nodes.size(); n-- > 0;) {
+		const NodeData& node = data.nodes[n];
+		if (node.parent >= 0 && !node.bounds.isEmpty())
+			data.nodes[node.parent].bounds.merge(node.bounds.transformed(aiToGlm(node.transformation)));
+	}
+}
+
+// Volumen del modelo: Model::Draw dibuja los meshes sin transformacion de nodo, asi que
+// es la union directa de los volumenes de los meshes
+inline void computeModelBounds(ModelData& data)
+{
+	data.bounds = Bounds::empty();
+	for (const MeshData& mesh : data.meshes)
+		data.bounds.merge(mesh.bounds);
+}
+
+// Genera la cadena de LODs de los meshes estaticos (ya combinados, si se pidio)
+inline void generateLods(ModelData& data)
+{
+	for (MeshData& mesh : data.meshes) {
+		if (!mesh.mergeable || mesh.numIndices == 0) continue;
+
+		auto start = std::chrono::steady_clock::now();
+		buildMeshLods(mesh.vertexStorage.data(), mesh.numVertices, mesh.indexStorage, mesh.lods);
+		mesh.numIndices = mesh.indexStorage.size();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		data.importStats.lodMillis += elapsed.count();
+		if (mesh.lods.empty()) continue;
+		data.importStats.lodMeshes++;
+		data.importStats.lodLevels += mesh.lods.size();
+		if (!MODEL_IMPORT_VERBOSE) continue;
+
+		cout << "Mesh LODs: triangles";
+		for (const MeshLod& lod : mesh.lods)
+			cout << " " << lod.numIndices / 3;
+		cout << ", error " << mesh.lods.back().error << " (" << elapsed.count() << " ms)" << endl;
+	}
+}
+
+// Parte el nivel 0 de los meshes estaticos en meshlets. En los meshes combinados cada
+// submesh se parte por separado para que sus rangos de indices sigan siendo validos.
+inline void generateMeshlets(ModelData& data)
+{
+	for (MeshData& mesh : data.meshes) {
+		if (!mesh.mergeable || mesh.numIndices == 0) continue;
+
+		if (mesh.submeshes.empty()) {
+			buildMeshlets(mesh.vertexStorage.data(), mesh.numVertices, mesh.indexStorage, 0, mesh.baseIndexCount(), mesh.meshlets);
+		}
+		else {
+			for (const SubMeshRange& range : mesh.submeshes)
+				buildMeshlets(mesh.vertexStorage.data(), mesh.numVertices, mesh.indexStorage, range.firstIndex, range.numIndices, mesh.meshlets);
+		}
+
+		// los meshlets cambian el orden de los triangulos del nivel 0: se vuelve a ordenar
+		// la lectura de vertices con todo el buffer (nivel 0 y LODs). Como el nivel 0 va
+		// primero y cada submesh usa solo sus vertices, los rangos de los submeshes no cambian
+		optimizeVertexFetch(mesh.vertexStorage, mesh.indexStorage);
+		mesh.numVertices = mesh.vertexStorage.size();
+		data.importStats.meshlets += mesh.meshlets.size();
+		if (MODEL_IMPORT_VERBOSE)
+			cout << "Mesh meshlets: " << mesh.meshlets.size() << " for " << mesh.baseIndexCount() / 3 << " triangles" << endl;
+	}
+}
+
+// Una linea por modelo importado, con los totales de todos sus meshes
+inline void printImportSummary(const ModelData& data, double milliseconds)
+{
+	const ImportStats& stats = data.importStats;
+	cout << "Model imported: " << data.path << " | " << stats.importedMeshes << " meshes";
+	if (stats.importedMeshes != data.meshes.size())
+		cout << " (" << data.meshes.size() << " after merge)";
+	cout << ", vertices " << stats.verticesBefore << " -> " << stats.verticesAfter;
+	if (stats.optimizedTriangles > 0)
+		cout << ", ACMR " << stats.cacheMissesBefore / stats.optimizedTriangles << " -> "
+			<< stats.cacheMissesAfter / stats.optimizedTriangles;
+	cout << ", " << stats.bytesBefore / 1024 << " KB -> " << stats.bytesAfter / 1024 << " KB";
+	if (stats.skinWeights > 0)
+		cout << ", " << stats.skinWeights << " skin weights (" << stats.skinMillis << " ms)";
+	if (stats.lodMeshes > 0)
+		cout << ", " << stats.lodLevels << " LODs in " << stats.lodMeshes << " meshes (" << stats.lodMillis << " ms)";
+	if (stats.meshlets > 0)
+		cout << ", " << stats.meshlets << " meshlets";
+	cout << " | " << milliseconds << " ms" << endl;
+}
+
+// Pasa un mesh importado al formato de la GPU y suelta los Vertex: lo que se guarda en el
+// cache y se sube es exactamente esto
+inline void packMeshData(MeshData& mesh)
+{
+	mesh.skinned = hasSkinWeights(mesh.vertexStorage.data(), mesh.numVertices);
+	packVertices(mesh.vertexStorage.data(), mesh.numVertices, mesh.skinned, mesh.packedVertices);
+	packIndices(mesh.indexStorage.data(), mesh.numIndices, mesh.numVertices, mesh.packedIndices);
+	vector<Vertex>().swap(mesh.vertexStorage);
+	vector<unsigned int>().swap(mesh.indexStorage);
+}
+
+inline bool importModel(Assimp::Importer& importer, const string& path, ModelData& data, const ImportOptions& options = ImportOptions())
+{
+	auto start = std::chrono::steady_clock::now();
+	// read file via ASSIMP
+	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+	// check for errors
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
+	{
+		cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
+		return false;
+	}
+
+	data.path = path;
+	data.directory = path.substr(0, path.find_last_of('/'));
+
+	aiMatrix4x4 inverseTransform = scene->mRootNode->mTransformation;
+	inverseTransform.Inverse();
+	data.globalInverseTransform = aiToGlm(inverseTransform);
+
+	importNode(scene->mRootNode, -1, scene, data);
+	importMaterials(scene, data);
+	importAnimations(scene, data);
+
+	computeNodeBounds(data);
+	if (options.mergeStaticMeshes)
+		mergeStaticMeshes(data);
+	generateLods(data);
+	generateMeshlets(data);
+	computeModelBounds(data);
+	for (MeshData& mesh : data.meshes)
+		packMeshData(mesh);
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	printImportSummary(data, elapsed.count());
+	return true;
+}
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <mesh.h>
 #include <shader.h>
+#include <texturecooker.h>
 
 #include <string>
 #include <fstream>
@@ -68,10 +69,20 @@ struct VertexBoneData
 	}
 };
 
+// Propiedades del material leidas del FBX
+struct MaterialProperties {
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;
+	float metallic;
+	float roughness;
+	float ior;
+	float alpha;
+};
+
+// Los pesos por vertice viven en el vertex buffer; el hueso solo guarda su matriz
 struct Bone {
 	aiString name;
-	vector<unsigned int>    IDs;
-	vector<float>           weights;
 	glm::mat4               transformation;
 	glm::mat4               offsetMatrix;
 
@@ -80,12 +91,6 @@ struct Bone {
 		transformation = glm::mat4(1.0f);
 		offsetMatrix   = glm::mat4(1.0f);
 	};
-
-	void push(unsigned int ID, float w) {
-		IDs.push_back(ID);
-		weights.push_back(w);
-	}
-
 };
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
@@ -93,38 +98,11 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
     string filename = string(path);
     filename = directory + '/' + filename;
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
+    CompressedImage image;
+    if (!loadCookedTexture(filename, TEXTURE_ROLE_COLOR, image))
         std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
 
-    return textureID;
+    // gamma: muestrear como sRGB para que el shader reciba color lineal
+    return uploadCompressedTexture(image, gamma);
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,87 @@
+#ifndef POSEPOOL_H
+#define POSEPOOL_H
+
+#include <skeleton.h>
+
+#include <algorithm>
+#include <memory>
+
+// ============================================================================
+// POOL DE POSES
+// Buffers de poses intermedias (clips muestreados, mezclas parciales) para evaluar un
+// arbol de mezcla sin pedir memoria al heap. Es una pila: acquire() avanza el tope y
+// PosePool::Scope lo devuelve a donde estaba al salir. Los bloques nunca se liberan,
+// asi que despues de los primeros frames (el arbol mas profundo ya paso) no se reserva
+// nada mas. Cada hilo usa el suyo con forThread().
+// ============================================================================
+
+#define POSE_POOL_BLOCK_TRANSFORMS 4096
+
+class PosePool
+{
+public:
+	struct Mark {
+		size_t block;
+		size_t used;
+	};
+
+	// Devuelve el tope del pool a donde estaba al crearse
+	class Scope
+	{
+	public:
+		explicit Scope(PosePool& pool) : pool(pool), mark(pool.getMark()) {}
+		~Scope() { pool.rewind(mark); }
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		PosePool& pool;
+		Mark      mark;
+	};
+
+	PosePool() : current(0), used(0) {}
+	PosePool(const PosePool&) = delete;
+	PosePool& operator=(const PosePool&) = delete;
+
+	static PosePool& forThread()
+	{
+		static thread_local PosePool pool;
+		return pool;
+	}
+
+	// count transformaciones contiguas, validas hasta que se rebobine por debajo de ellas
+	NodeTransform* acquire(size_t count)
+	{
+		while (current < blocks.size() && used + count > blocks[current].size) {
+			current++;
+			used = 0;
+		}
+		if (current == blocks.size()) {
+			Block block;
+			block.size = std::max(count, (size_t)POSE_POOL_BLOCK_TRANSFORMS);
+			block.data.reset(new NodeTransform[block.size]);
+			blocks.push_back(std::move(block));
+			used = 0;
+		}
+		NodeTransform* pose = blocks[current].data.get() + used;
+		used += count;
+		return pose;
+	}
+
+	Mark getMark() const { return { current, used }; }
+	void rewind(const Mark& mark) { current = mark.block; used = mark.used; }
+
+	size_t getBlockCount() const { return blocks.size(); }
+
+private:
+	struct Block {
+		std::unique_ptr<NodeTransform[]> data;
+		size_t                           size;
+	};
+
+	vector<Block> blocks;
+	size_t        current; // bloque donde se reserva
+	size_t        used;    // transformaciones usadas de ese bloque
+};
+
+#endif
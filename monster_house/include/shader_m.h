@@ -9,16 +9,24 @@
 #include <sstream>
 #include <iostream>
 
+#include <assetpack.h>
+
 class Shader
 {
 public:
     unsigned int ID;
 	GLuint m_boneLocation[100];
+	// source files, kept so the program can be rebuilt when they change (hot reload)
+	std::string vertexFile, fragmentFile, geometryFile;
+	unsigned int boneCount = 0;
 
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
     {
+        vertexFile = vertexPath;
+        fragmentFile = fragmentPath;
+        geometryFile = geometryPath ? geometryPath : "";
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
@@ -30,6 +38,14 @@ public:
         vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
         fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
         gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        // cooked builds read the mounted asset pack; otherwise loose files win so that
+        // edits are picked up, and the pack is only a fallback
+        auto readPacked = [&]() {
+            return readPackedText(vertexPath, vertexCode) && readPackedText(fragmentPath, fragmentCode) &&
+                (geometryPath == nullptr || readPackedText(geometryPath, geometryCode));
+        };
+        bool packed = COOKED_ASSETS_ONLY && readPacked();
+        if (!packed)
         try 
         {
             // open files
@@ -58,7 +74,8 @@ public:
         catch (std::ifstream::failure& e)
         {
 			e;
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+            if (!readPacked())
+                std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
         }
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
@@ -105,6 +122,13 @@ public:
     { 
         glUseProgram(ID); 
     }
+    // true if the program linked (a failed hot reload keeps the previous program)
+    bool isLinked() const
+    {
+        GLint status = GL_FALSE;
+        glGetProgramiv(ID, GL_LINK_STATUS, &status);
+        return status == GL_TRUE;
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
@@ -170,6 +194,7 @@ public:
 	}
 
 	void setBonesIDs(unsigned int max_bones) {
+		boneCount = max_bones;
 		for (unsigned int i = 0; i < max_bones; i++) {
 			char Name[128];
 			memset(Name, 0, sizeof(Name));
@@ -0,0 +1,624 @@
+#ifndef SKELETON_H
+#define SKELETON_H
+
+#include <modelimporter.h>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <unordered_map>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SKELETON_SSE2 1
+#endif
+
+// ============================================================================
+// SKELETON COMPILADO
+// Se arma una vez al cargar, a partir de la jerarquia en preorden: por nodo, su padre
+// y el canal que lo anima en cada clip; por hueso, el nodo que lo mueve. Las claves de
+// cada canal se copian en SoA (un arreglo de floats por componente).
+//
+// Las poses se evaluan en lotes de SKELETON_BATCH_LANES instancias del mismo skeleton,
+// una por carril SIMD. Por nodo se buscan las claves de cada instancia y despues la
+// interpolacion (lerp de posicion y escala, nlerp de rotacion), la composicion T * R * S
+// y los productos de matrices se hacen para las cuatro a la vez. Es una sola pasada
+// lineal sobre los nodos (el padre siempre ya esta calculado) y otra sobre los huesos,
+// sin nombres ni recursion.
+//
+// Una vez compilado no cambia: el estado de reproduccion (cursores, tiempo, paleta de
+// huesos) es de cada instancia, asi que varias pueden compartir el mismo skeleton.
+//
+// Para mezclar clips (animgraph.h) hay un camino escalar en dos pasos: sampleLocalPose
+// deja la transformacion local de cada nodo por separado (posicion, rotacion, escala),
+// las poses se combinan, y composePose arma la jerarquia y la paleta de huesos.
+// ============================================================================
+
+#define SKELETON_BATCH_LANES 4
+// Como aiMatrix4x4::IsIdentity (ai_epsilon): la evaluacion original solo aplicaba la
+// traslacion de un canal si su matriz de escala era la identidad
+#define SKELETON_IDENTITY_EPSILON 1e-6f
+
+// Ultimo segmento de claves usado por un canal. La reproduccion avanza de a poco, asi
+// que casi siempre el segmento buscado es el mismo o el siguiente.
+struct KeyCursor {
+	unsigned int position = 0;
+	unsigned int rotation = 0;
+	unsigned int scaling = 0;
+};
+
+// Estado de reproduccion de una instancia: el clip que evaluo por ultima vez y un
+// cursor de claves por nodo. Al cambiar de clip los cursores vuelven al inicio.
+struct AnimationCursor {
+	unsigned int      clip = UINT_MAX;
+	vector<KeyCursor> keys;
+};
+
+// Claves de un canal en SoA; w solo se usa en rotaciones
+struct KeyTrack {
+	vector<float> times;
+	vector<float> x, y, z, w;
+};
+
+struct ChannelTracks {
+	KeyTrack position;
+	KeyTrack rotation;
+	KeyTrack scaling;
+};
+
+// Transformacion local de un nodo sin componer; la rotacion es un cuaternion (x, y, z, w)
+struct NodeTransform {
+	glm::vec3 position;
+	glm::vec4 rotation;
+	glm::vec3 scale;
+};
+
+inline NodeTransform identityTransform()
+{
+	return { glm::vec3(0.0f), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec3(1.0f) };
+}
+
+inline glm::vec4 quatMultiply(const glm::vec4& a, const glm::vec4& b)
+{
+	return glm::vec4(
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+// Inversa de un cuaternion unitario
+inline glm::vec4 quatConjugate(const glm::vec4& q)
+{
+	return glm::vec4(-q.x, -q.y, -q.z, q.w);
+}
+
+// nlerp por el camino corto, igual que la evaluacion por carriles
+inline glm::vec4 quatNlerp(const glm::vec4& a, const glm::vec4& b, float factor)
+{
+	float weightB = glm::dot(a, b) < 0.0f ? -factor : factor;
+	return glm::normalize(a * (1.0f - factor) + b * weightB);
+}
+
+// T * R * S en el orden de glm
+inline glm::mat4 transformMatrix(const NodeTransform& transform)
+{
+	const glm::vec4& q = transform.rotation;
+	const glm::vec3& s = transform.scale;
+	glm::mat4 m(1.0f);
+	m[0][0] = (1.0f - 2.0f * (q.y * q.y + q.z * q.z)) * s.x;
+	m[0][1] = 2.0f * (q.x * q.y + q.w * q.z) * s.x;
+	m[0][2] = 2.0f * (q.x * q.z - q.w * q.y) * s.x;
+	m[1][0] = 2.0f * (q.x * q.y - q.w * q.z) * s.y;
+	m[1][1] = (1.0f - 2.0f * (q.x * q.x + q.z * q.z)) * s.y;
+	m[1][2] = 2.0f * (q.y * q.z + q.w * q.x) * s.y;
+	m[2][0] = 2.0f * (q.x * q.z + q.w * q.y) * s.z;
+	m[2][1] = 2.0f * (q.y * q.z - q.w * q.x) * s.z;
+	m[2][2] = (1.0f - 2.0f * (q.x * q.x + q.y * q.y)) * s.z;
+	m[3] = glm::vec4(transform.position, 1.0f);
+	return m;
+}
+
+// Devuelve el primer i con AnimationTime < times[i + 1]. Prueba el cursor y el
+// segmento siguiente en O(1); si no (salto o vuelta al inicio), busqueda binaria.
+inline unsigned int findKey(float AnimationTime, const vector<float>& times, unsigned int& cursor)
+{
+	assert(times.size() > 0);
+
+	unsigned int last = (unsigned int)times.size() - 1;
+	for (unsigned int i = cursor; i < last && i <= cursor + 1; i++) {
+		if (AnimationTime < times[i + 1]) {
+			if (i == 0 || AnimationTime >= times[i]) {
+				cursor = i;
+				return i;
+			}
+			break;
+		}
+	}
+
+	auto next = std::upper_bound(times.begin() + 1, times.end(), AnimationTime);
+	if (next == times.end()) {
+		assert(0);
+		return 0;
+	}
+	cursor = (unsigned int)(next - times.begin()) - 1;
+	return cursor;
+}
+
+// ----------------------------------------------------------------------------
+// Carriles: un float por instancia del lote (SSE2, o escalar sin SSE2)
+// ----------------------------------------------------------------------------
+
+struct PoseLanes {
+#if defined(SKELETON_SSE2)
+	__m128 v;
+
+	static PoseLanes load(const float* p) { return { _mm_load_ps(p) }; }
+	static PoseLanes set(float f) { return { _mm_set1_ps(f) }; }
+	void store(float* p) const { _mm_store_ps(p, v); }
+
+	friend PoseLanes operator+(PoseLanes a, PoseLanes b) { return { _mm_add_ps(a.v, b.v) }; }
+	friend PoseLanes operator-(PoseLanes a, PoseLanes b) { return { _mm_sub_ps(a.v, b.v) }; }
+	friend PoseLanes operator*(PoseLanes a, PoseLanes b) { return { _mm_mul_ps(a.v, b.v) }; }
+	friend PoseLanes operator/(PoseLanes a, PoseLanes b) { return { _mm_div_ps(a.v, b.v) }; }
+	friend PoseLanes sqrt(PoseLanes a) { return { _mm_sqrt_ps(a.v) }; }
+	friend PoseLanes abs(PoseLanes a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+	// mascaras: todos los bits en 1 donde se cumple
+	friend PoseLanes lessThan(PoseLanes a, PoseLanes b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+	friend PoseLanes lessEqual(PoseLanes a, PoseLanes b) { return { _mm_cmple_ps(a.v, b.v) }; }
+	friend PoseLanes operator&(PoseLanes a, PoseLanes b) { return { _mm_and_ps(a.v, b.v) }; }
+	friend PoseLanes select(PoseLanes mask, PoseLanes a, PoseLanes b) {
+		return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+	}
+#else
+	float v[SKELETON_BATCH_LANES];
+
+	static PoseLanes load(const float* p) { PoseLanes r; for (int i = 0; i < SKELETON_BATCH_LANES; i++) r.v[i] = p[i]; return r; }
+	static PoseLanes set(float f) { PoseLanes r; for (int i = 0; i < SKELETON_BATCH_LANES; i++) r.v[i] = f; return r; }
+	void store(float* p) const { for (int i = 0; i < SKELETON_BATCH_LANES; i++) p[i] = v[i]; }
+
+	template <typename F>
+	static PoseLanes map(PoseLanes a, PoseLanes b, F f) { PoseLanes r; for (int i = 0; i < SKELETON_BATCH_LANES; i++) r.v[i] = f(a.v[i], b.v[i]); return r; }
+	static float maskValue(bool condition) { return condition ? 1.0f : 0.0f; }
+
+	friend PoseLanes operator+(PoseLanes a, PoseLanes b) { return map(a, b, [](float x, float y) { return x + y; }); }
+	friend PoseLanes operator-(PoseLanes a, PoseLanes b) { return map(a, b, [](float x, float y) { return x - y; }); }
+	friend PoseLanes operator*(PoseLanes a, PoseLanes b) { return map(a, b, [](float x, float y) { return x * y; }); }
+	friend PoseLanes operator/(PoseLanes a, PoseLanes b) { return map(a, b, [](float x, float y) { return x / y; }); }
+	friend PoseLanes sqrt(PoseLanes a) { return map(a, a, [](float x, float) { return std::sqrt(x); }); }
+	friend PoseLanes abs(PoseLanes a) { return map(a, a, [](float x, float) { return std::fabs(x); }); }
+	// mascaras: 1 donde se cumple, 0 donde no
+	friend PoseLanes lessThan(PoseLanes a, PoseLanes b) { return map(a, b, [](float x, float y) { return maskValue(x < y); }); }
+	friend PoseLanes lessEqual(PoseLanes a, PoseLanes b) { return map(a, b, [](float x, float y) { return maskValue(x <= y); }); }
+	friend PoseLanes operator&(PoseLanes a, PoseLanes b) { return map(a, b, [](float x, float y) { return maskValue(x != 0.0f && y != 0.0f); }); }
+	friend PoseLanes select(PoseLanes mask, PoseLanes a, PoseLanes b) {
+		PoseLanes r;
+		for (int i = 0; i < SKELETON_BATCH_LANES; i++) r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+		return r;
+	}
+#endif
+};
+
+// Matriz 4x4 por carril, en el orden de glm (columna * 4 + fila)
+struct PoseLaneMatrix {
+	PoseLanes m[16];
+
+	static PoseLaneMatrix identity()
+	{
+		PoseLaneMatrix r;
+		for (int i = 0; i < 16; i++)
+			r.m[i] = PoseLanes::set(i % 5 == 0 ? 1.0f : 0.0f);
+		return r;
+	}
+
+	static PoseLaneMatrix broadcast(const glm::mat4& a)
+	{
+		PoseLaneMatrix r;
+		for (int c = 0; c < 4; c++)
+			for (int row = 0; row < 4; row++)
+				r.m[c * 4 + row] = PoseLanes::set(a[c][row]);
+		return r;
+	}
+
+	friend PoseLaneMatrix operator*(const PoseLaneMatrix& a, const PoseLaneMatrix& b)
+	{
+		PoseLaneMatrix r;
+		for (int c = 0; c < 4; c++) {
+			for (int row = 0; row < 4; row++) {
+				r.m[c * 4 + row] = a.m[row] * b.m[c * 4] + a.m[4 + row] * b.m[c * 4 + 1] +
+					a.m[8 + row] * b.m[c * 4 + 2] + a.m[12 + row] * b.m[c * 4 + 3];
+			}
+		}
+		return r;
+	}
+
+	// Producto por una matriz igual en todos los carriles (offsets de huesos)
+	PoseLaneMatrix operator*(const glm::mat4& b) const
+	{
+		PoseLaneMatrix r;
+		for (int c = 0; c < 4; c++) {
+			PoseLanes b0 = PoseLanes::set(b[c][0]), b1 = PoseLanes::set(b[c][1]);
+			PoseLanes b2 = PoseLanes::set(b[c][2]), b3 = PoseLanes::set(b[c][3]);
+			for (int row = 0; row < 4; row++)
+				r.m[c * 4 + row] = m[row] * b0 + m[4 + row] * b1 + m[8 + row] * b2 + m[12 + row] * b3;
+		}
+		return r;
+	}
+};
+
+// Copia de los clips sin sus canales (nombre, duracion y ticks por segundo): una vez
+// compilado el skeleton, las claves de Assimp ya no se usan
+inline vector<AnimationClip> clipHeaders(const vector<AnimationClip>& animations)
+{
+	vector<AnimationClip> headers(animations.size());
+	for (size_t a = 0; a < animations.size(); a++) {
+		headers[a].name = animations[a].name;
+		headers[a].duration = animations[a].duration;
+		headers[a].ticksPerSecond = animations[a].ticksPerSecond;
+	}
+	return headers;
+}
+
+class CompiledSkeleton
+{
+public:
+	// Resuelve los nombres una sola vez. Los nodos vienen en preorden (ModelData::nodes).
+	void compile(const vector<NodeData>& nodes, const vector<Bone>& bones, const vector<AnimationClip>& animations)
+	{
+		std::unordered_map<string, int> nodeIndex;
+		nodeIndex.reserve(nodes.size());
+		parents.resize(nodes.size());
+		for (size_t n = 0; n < nodes.size(); n++) {
+			parents[n] = nodes[n].parent;
+			nodeIndex[nodes[n].name] = (int)n; // con nombres repetidos gana el ultimo, como antes
+		}
+
+		boneNodes.resize(bones.size());
+		boneOffsets.resize(bones.size());
+		for (size_t b = 0; b < bones.size(); b++) {
+			auto node = nodeIndex.find(bones[b].name.C_Str());
+			boneNodes[b] = node != nodeIndex.end() ? node->second : -1;
+			boneOffsets[b] = bones[b].offsetMatrix;
+		}
+
+		channels.assign(animations.size(), vector<int>(nodes.size(), -1));
+		tracks.assign(animations.size(), vector<ChannelTracks>());
+		std::unordered_map<string, int> channelIndex;
+		for (size_t a = 0; a < animations.size(); a++) {
+			const vector<AnimationChannel>& clipChannels = animations[a].channels;
+			channelIndex.clear();
+			for (size_t c = 0; c < clipChannels.size(); c++)
+				channelIndex.emplace(clipChannels[c].nodeName, (int)c); // como antes, gana el primer canal
+			for (size_t n = 0; n < nodes.size(); n++) {
+				auto channel = channelIndex.find(nodes[n].name);
+				if (channel != channelIndex.end())
+					channels[a][n] = channel->second;
+			}
+
+			tracks[a].resize(clipChannels.size());
+			for (size_t c = 0; c < clipChannels.size(); c++) {
+				ChannelTracks& track = tracks[a][c];
+				for (const aiVectorKey& key : clipChannels[c].positionKeys)
+					appendKey(track.position, key.mTime, key.mValue.x, key.mValue.y, key.mValue.z, 0.0f);
+				for (const aiQuatKey& key : clipChannels[c].rotationKeys)
+					appendKey(track.rotation, key.mTime, key.mValue.x, key.mValue.y, key.mValue.z, key.mValue.w);
+				for (const aiVectorKey& key : clipChannels[c].scalingKeys)
+					appendKey(track.scaling, key.mTime, key.mValue.x, key.mValue.y, key.mValue.z, 0.0f);
+				// un canal sin claves de algun tipo queda en reposo para ese tipo
+				if (track.position.times.empty()) appendKey(track.position, 0.0, 0.0f, 0.0f, 0.0f, 0.0f);
+				if (track.rotation.times.empty()) appendKey(track.rotation, 0.0, 0.0f, 0.0f, 0.0f, 1.0f);
+				if (track.scaling.times.empty()) appendKey(track.scaling, 0.0, 1.0f, 1.0f, 1.0f, 0.0f);
+			}
+		}
+	}
+
+	// Bytes de CPU que deja compile() con estos datos, sin compilarlos: para el reporte
+	// de memoria de un modelo antes de que lo cargue Model/AnimatedModel
+	static size_t compiledBytes(const vector<NodeData>& nodes, const vector<Bone>& bones, const vector<AnimationClip>& animations)
+	{
+		size_t bytes = nodes.size() * sizeof(int) + bones.size() * (sizeof(int) + sizeof(glm::mat4));
+		for (const AnimationClip& clip : animations) {
+			bytes += nodes.size() * sizeof(int) + clip.channels.size() * sizeof(ChannelTracks);
+			// por clave: tiempo, x, y, z, w; un tipo sin claves queda con una en reposo
+			for (const AnimationChannel& channel : clip.channels)
+				bytes += (std::max<size_t>(channel.positionKeys.size(), 1) + std::max<size_t>(channel.rotationKeys.size(), 1) +
+					std::max<size_t>(channel.scalingKeys.size(), 1)) * 5 * sizeof(float);
+		}
+		return bytes;
+	}
+
+	size_t getNodeCount() const { return parents.size(); }
+	size_t getBoneCount() const { return boneNodes.size(); }
+	size_t getClipCount() const { return channels.size(); }
+
+	/**
+	 * Pose del clip en el instante time (en ticks) para una sola instancia. Escribe hasta
+	 * maxBones matrices en boneTransforms; los huesos sin nodo quedan en identidad.
+	 */
+	void evaluate(unsigned int clip, float time, const glm::mat4& globalInverseTransform,
+		AnimationCursor& cursor, glm::mat4* boneTransforms, size_t maxBones) const
+	{
+		AnimationCursor* cursors[1] = { &cursor };
+		glm::mat4* outputs[1] = { boneTransforms };
+		evaluateBatch(clip, 1, &time, cursors, globalInverseTransform, outputs, maxBones);
+	}
+
+	/**
+	 * Poses del mismo clip para count instancias: la instancia i usa times[i] y
+	 * cursors[i] y escribe en boneTransforms[i]. Se procesan de a SKELETON_BATCH_LANES.
+	 */
+	void evaluateBatch(unsigned int clip, size_t count, const float* times, AnimationCursor* const* cursors,
+		const glm::mat4& globalInverseTransform, glm::mat4* const* boneTransforms, size_t maxBones) const
+	{
+		assert(clip < channels.size());
+		// transformaciones globales del lote en curso, propias de cada hilo
+		static thread_local vector<PoseLaneMatrix> nodeGlobals;
+		nodeGlobals.resize(parents.size());
+		const int* nodeChannels = channels[clip].data();
+		const ChannelTracks* clipTracks = tracks[clip].data();
+		PoseLaneMatrix globalInverse = PoseLaneMatrix::broadcast(globalInverseTransform);
+		size_t boneCount = std::min(boneNodes.size(), maxBones);
+
+		for (size_t first = 0; first < count; first += SKELETON_BATCH_LANES) {
+			int active = (int)std::min((size_t)SKELETON_BATCH_LANES, count - first);
+
+			// los carriles sin instancia repiten el tiempo de la ultima con cursores de descarte
+			float laneTimes[SKELETON_BATCH_LANES];
+			KeyCursor* laneCursors[SKELETON_BATCH_LANES];
+			KeyCursor spareCursors[SKELETON_BATCH_LANES];
+			for (int lane = 0; lane < SKELETON_BATCH_LANES; lane++) {
+				if (lane < active) {
+					AnimationCursor& cursor = *cursors[first + lane];
+					if (cursor.clip != clip || cursor.keys.size() != parents.size()) {
+						cursor.clip = clip;
+						cursor.keys.assign(parents.size(), KeyCursor());
+					}
+					laneTimes[lane] = times[first + lane];
+					laneCursors[lane] = cursor.keys.data();
+				}
+				else {
+					laneTimes[lane] = laneTimes[active - 1];
+					laneCursors[lane] = nullptr;
+				}
+			}
+
+			for (size_t n = 0; n < parents.size(); n++) {
+				int channel = nodeChannels[n];
+				int parent = parents[n];
+				if (channel < 0) {
+					// sin canal la transformacion local es la identidad
+					nodeGlobals[n] = parent >= 0 ? nodeGlobals[parent] : PoseLaneMatrix::identity();
+					continue;
+				}
+
+				KeyCursor* nodeCursors[SKELETON_BATCH_LANES];
+				for (int lane = 0; lane < SKELETON_BATCH_LANES; lane++)
+					nodeCursors[lane] = laneCursors[lane] ? &laneCursors[lane][n] : &spareCursors[lane];
+
+				PoseLaneMatrix local = sampleChannel(clipTracks[channel], laneTimes, nodeCursors);
+				nodeGlobals[n] = parent >= 0 ? nodeGlobals[parent] * local : local;
+			}
+
+			for (size_t b = 0; b < boneCount; b++) {
+				int node = boneNodes[b];
+				if (node < 0) {
+					for (int lane = 0; lane < active; lane++)
+						boneTransforms[first + lane][b] = glm::mat4(1.0f);
+					continue;
+				}
+				storeLanes(globalInverse * (nodeGlobals[node] * boneOffsets[b]), boneTransforms + first, b, active);
+			}
+		}
+	}
+
+	/**
+	 * Transformacion local de cada nodo (getNodeCount() entradas) del clip en el instante
+	 * time. Los nodos sin canal quedan en identidad y, como en la evaluacion original, la
+	 * posicion de un canal se descarta si su escala no es la identidad.
+	 */
+	void sampleLocalPose(unsigned int clip, float time, AnimationCursor& cursor, NodeTransform* pose) const
+	{
+		assert(clip < channels.size());
+		if (cursor.clip != clip || cursor.keys.size() != parents.size()) {
+			cursor.clip = clip;
+			cursor.keys.assign(parents.size(), KeyCursor());
+		}
+
+		const int* nodeChannels = channels[clip].data();
+		const ChannelTracks* clipTracks = tracks[clip].data();
+		for (size_t n = 0; n < parents.size(); n++) {
+			int channel = nodeChannels[n];
+			if (channel < 0) {
+				pose[n] = identityTransform();
+				continue;
+			}
+			const ChannelTracks& track = clipTracks[channel];
+			KeyCursor& keys = cursor.keys[n];
+			NodeTransform& out = pose[n];
+			out.scale = glm::vec3(sampleTrack(track.scaling, time, keys.scaling));
+			out.position = glm::vec3(sampleTrack(track.position, time, keys.position));
+			glm::vec4 a, b;
+			float factor = sampleSegment(track.rotation, time, keys.rotation, a, b);
+			out.rotation = quatNlerp(a, b, factor);
+
+			glm::vec3 scaleError = glm::abs(out.scale - glm::vec3(1.0f));
+			if (scaleError.x > SKELETON_IDENTITY_EPSILON || scaleError.y > SKELETON_IDENTITY_EPSILON ||
+				scaleError.z > SKELETON_IDENTITY_EPSILON)
+				out.position = glm::vec3(0.0f);
+		}
+	}
+
+	// Jerarquia y paleta de huesos a partir de una pose local (getNodeCount() entradas)
+	void composePose(const NodeTransform* pose, const glm::mat4& globalInverseTransform,
+		glm::mat4* boneTransforms, size_t maxBones) const
+	{
+		static thread_local vector<glm::mat4> globals;
+		globals.resize(parents.size());
+		for (size_t n = 0; n < parents.size(); n++) {
+			glm::mat4 local = transformMatrix(pose[n]);
+			globals[n] = parents[n] >= 0 ? globals[parents[n]] * local : local;
+		}
+
+		size_t count = std::min(boneNodes.size(), maxBones);
+		for (size_t b = 0; b < count; b++) {
+			int node = boneNodes[b];
+			boneTransforms[b] = node >= 0 ? globalInverseTransform * globals[node] * boneOffsets[b] : glm::mat4(1.0f);
+		}
+	}
+
+private:
+	vector<int>                   parents;     // por nodo, -1 en la raiz
+	vector<vector<int>>           channels;    // [clip][nodo] -> canal del clip, -1 si no esta animado
+	vector<vector<ChannelTracks>> tracks;      // [clip][canal] claves en SoA
+	vector<int>                   boneNodes;   // por hueso, nodo que lo mueve (-1 si no existe)
+	vector<glm::mat4>             boneOffsets;
+
+	static void appendKey(KeyTrack& track, double time, float x, float y, float z, float w)
+	{
+		track.times.push_back((float)time);
+		track.x.push_back(x);
+		track.y.push_back(y);
+		track.z.push_back(z);
+		track.w.push_back(w);
+	}
+
+	// Claves vecinas de un track en time y el factor entre ellas (0 con una sola clave)
+	static float sampleSegment(const KeyTrack& track, float time, unsigned int& cursor, glm::vec4& a, glm::vec4& b)
+	{
+		unsigned int index = 0, next = 0;
+		float factor = 0.0f;
+		if (track.times.size() > 1) {
+			index = findKey(time, track.times, cursor);
+			next = index + 1;
+			assert(next < track.times.size());
+			factor = (time - track.times[index]) / (track.times[next] - track.times[index]);
+			assert(factor >= 0.0f && factor <= 1.0f);
+		}
+		a = glm::vec4(track.x[index], track.y[index], track.z[index], track.w[index]);
+		b = glm::vec4(track.x[next], track.y[next], track.z[next], track.w[next]);
+		return factor;
+	}
+
+	static glm::vec4 sampleTrack(const KeyTrack& track, float time, unsigned int& cursor)
+	{
+		glm::vec4 a, b;
+		float factor = sampleSegment(track, time, cursor, a, b);
+		return a + factor * (b - a);
+	}
+
+	// Claves vecinas y factor de cada carril, listos para cargar en registros
+	struct LaneKeys {
+		alignas(16) float a[4][SKELETON_BATCH_LANES];
+		alignas(16) float b[4][SKELETON_BATCH_LANES];
+		alignas(16) float factor[SKELETON_BATCH_LANES];
+	};
+
+	static void gatherKeys(const KeyTrack& track, const float* laneTimes, KeyCursor* const* cursors,
+		unsigned int KeyCursor::* segment, int components, LaneKeys& keys)
+	{
+		const float* values[4] = { track.x.data(), track.y.data(), track.z.data(), track.w.data() };
+		for (int lane = 0; lane < SKELETON_BATCH_LANES; lane++) {
+			unsigned int index = 0, next = 0;
+			float factor = 0.0f;
+			if (track.times.size() > 1) {
+				index = findKey(laneTimes[lane], track.times, cursors[lane]->*segment);
+				next = index + 1;
+				assert(next < track.times.size());
+				factor = (laneTimes[lane] - track.times[index]) / (track.times[next] - track.times[index]);
+				assert(factor >= 0.0f && factor <= 1.0f);
+			}
+			for (int c = 0; c < components; c++) {
+				keys.a[c][lane] = values[c][index];
+				keys.b[c][lane] = values[c][next];
+			}
+			keys.factor[lane] = factor;
+		}
+	}
+
+	// Transformacion local T * R * S de un nodo animado en los cuatro carriles
+	static PoseLaneMatrix sampleChannel(const ChannelTracks& track, const float* laneTimes, KeyCursor* const* cursors)
+	{
+		LaneKeys keys;
+		PoseLanes zero = PoseLanes::set(0.0f);
+		PoseLanes one = PoseLanes::set(1.0f);
+		PoseLanes two = PoseLanes::set(2.0f);
+
+		// escala y posicion: lerp
+		gatherKeys(track.scaling, laneTimes, cursors, &KeyCursor::scaling, 3, keys);
+		PoseLanes factor = PoseLanes::load(keys.factor);
+		PoseLanes scale[3];
+		for (int c = 0; c < 3; c++) {
+			PoseLanes a = PoseLanes::load(keys.a[c]);
+			scale[c] = a + factor * (PoseLanes::load(keys.b[c]) - a);
+		}
+
+		gatherKeys(track.position, laneTimes, cursors, &KeyCursor::position, 3, keys);
+		factor = PoseLanes::load(keys.factor);
+		PoseLanes position[3];
+		for (int c = 0; c < 3; c++) {
+			PoseLanes a = PoseLanes::load(keys.a[c]);
+			position[c] = a + factor * (PoseLanes::load(keys.b[c]) - a);
+		}
+
+		// rotacion: nlerp por el camino corto
+		gatherKeys(track.rotation, laneTimes, cursors, &KeyCursor::rotation, 4, keys);
+		factor = PoseLanes::load(keys.factor);
+		PoseLanes qa[4], qb[4];
+		for (int c = 0; c < 4; c++) {
+			qa[c] = PoseLanes::load(keys.a[c]);
+			qb[c] = PoseLanes::load(keys.b[c]);
+		}
+		PoseLanes dot = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+		PoseLanes weightA = one - factor;
+		PoseLanes weightB = select(lessThan(dot, zero), zero - factor, factor);
+		PoseLanes q[4];
+		for (int c = 0; c < 4; c++)
+			q[c] = qa[c] * weightA + qb[c] * weightB;
+		PoseLanes length = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+		PoseLanes x = q[0] / length, y = q[1] / length, z = q[2] / length, w = q[3] / length;
+
+		PoseLanes xx = x * x, yy = y * y, zz = z * z;
+		PoseLanes xy = x * y, xz = x * z, yz = y * z;
+		PoseLanes wx = w * x, wy = w * y, wz = w * z;
+
+		// la traslacion solo si la escala es la identidad, como la evaluacion original
+		PoseLanes epsilon = PoseLanes::set(SKELETON_IDENTITY_EPSILON);
+		PoseLanes unitScale = lessEqual(abs(scale[0] - one), epsilon) & lessEqual(abs(scale[1] - one), epsilon) &
+			lessEqual(abs(scale[2] - one), epsilon);
+
+		PoseLaneMatrix local;
+		local.m[0] = (one - two * (yy + zz)) * scale[0];
+		local.m[1] = two * (xy + wz) * scale[0];
+		local.m[2] = two * (xz - wy) * scale[0];
+		local.m[3] = zero;
+		local.m[4] = two * (xy - wz) * scale[1];
+		local.m[5] = (one - two * (xx + zz)) * scale[1];
+		local.m[6] = two * (yz + wx) * scale[1];
+		local.m[7] = zero;
+		local.m[8] = two * (xz + wy) * scale[2];
+		local.m[9] = two * (yz - wx) * scale[2];
+		local.m[10] = (one - two * (xx + yy)) * scale[2];
+		local.m[11] = zero;
+		local.m[12] = select(unitScale, position[0], zero);
+		local.m[13] = select(unitScale, position[1], zero);
+		local.m[14] = select(unitScale, position[2], zero);
+		local.m[15] = one;
+		return local;
+	}
+
+	// De carriles a una glm::mat4 por instancia activa
+	static void storeLanes(const PoseLaneMatrix& matrix, glm::mat4* const* outputs, size_t bone, int active)
+	{
+		alignas(16) float values[16][SKELETON_BATCH_LANES];
+		for (int i = 0; i < 16; i++)
+			matrix.m[i].store(values[i]);
+		for (int lane = 0; lane < active; lane++) {
+			glm::mat4& out = outputs[lane][bone];
+			for (int i = 0; i < 16; i++)
+				out[i / 4][i % 4] = values[i][lane];
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <threadpool.h>
+#include <uploadqueue.h>
+
+// ============================================================================
+// TAREAS ASINCRONAS (corrutinas de C++20)
+// Task<T> es perezosa: no corre hasta que alguien la espera con co_await (o la
+// arranca con start()). Cada tarea decide en que hilo sigue con co_await resumeOn():
+//  - resumeOn(pool):    continua en un hilo de trabajo (E/S, decodificacion).
+//  - resumeOn(uploads): continua en el hilo GL cuando este vacie la UploadQueue.
+// Quien espera una tarea se reanuda en el hilo donde la tarea termino. whenAll()
+// arranca varias a la vez y sigue cuando termina la ultima.
+// El proyecto no usa excepciones: una excepcion dentro de una tarea termina el proceso.
+// ============================================================================
+
+template <typename T> class Task;
+
+namespace detail
+{
+	struct TaskPromiseBase
+	{
+		std::coroutine_handle<> continuation;     // quien espera esta tarea
+		std::atomic<int>* whenAllCounter = nullptr; // solo dentro de whenAll()
+		std::atomic<bool> finished{ false };
+
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+
+			template <typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+			{
+				// se copia todo antes de marcar finished: desde ahi el dueno puede destruir el marco
+				TaskPromiseBase& promise = handle.promise();
+				std::coroutine_handle<> next = promise.continuation;
+				std::atomic<int>* counter = promise.whenAllCounter;
+				promise.finished.store(true, std::memory_order_release);
+				if (counter && counter->fetch_sub(1, std::memory_order_acq_rel) != 1)
+					return std::noop_coroutine();
+				return next ? next : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		std::suspend_always initial_suspend() const noexcept { return {}; }
+		FinalAwaiter final_suspend() const noexcept { return {}; }
+		void unhandled_exception() const noexcept { std::terminate(); }
+	};
+
+	template <typename T>
+	struct TaskPromise : TaskPromiseBase
+	{
+		std::optional<T> value;
+
+		Task<T> get_return_object() noexcept;
+		template <typename U>
+		void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+		T take() { return std::move(*value); }
+	};
+
+	template <>
+	struct TaskPromise<void> : TaskPromiseBase
+	{
+		Task<void> get_return_object() noexcept;
+		void return_void() const noexcept {}
+		void take() const noexcept {}
+	};
+}
+
+template <typename T = void>
+class Task
+{
+public:
+	typedef detail::TaskPromise<T> promise_type;
+	typedef std::coroutine_handle<promise_type> Handle;
+
+	Task() {}
+	explicit Task(Handle handle) : handle(handle) {}
+	Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other) {
+			if (handle) handle.destroy();
+			handle = std::exchange(other.handle, nullptr);
+		}
+		return *this;
+	}
+
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+
+	// Una tarea en curso no se puede destruir: sus hilos tienen el marco de la corrutina
+	~Task()
+	{
+		if (handle) handle.destroy();
+	}
+
+	// Arranca la tarea sin nadie que la espere (el nivel superior, desde el hilo GL).
+	// Corre hasta su primer cambio de hilo y vuelve; el progreso se consulta con isReady().
+	void start()
+	{
+		handle.resume();
+	}
+
+	bool isReady() const
+	{
+		return !handle || handle.promise().finished.load(std::memory_order_acquire);
+	}
+
+	// Solo con isReady(); mueve el resultado fuera de la tarea
+	T result()
+	{
+		return handle.promise().take();
+	}
+
+	struct Awaiter
+	{
+		Handle handle;
+
+		bool await_ready() const noexcept { return false; }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{
+			handle.promise().continuation = awaiting;
+			return handle;
+		}
+
+		T await_resume() { return handle.promise().take(); }
+	};
+
+	Awaiter operator co_await() && noexcept { return Awaiter{ handle }; }
+
+private:
+	template <typename U> friend class WhenAllAwaiter;
+
+	Handle handle;
+};
+
+namespace detail
+{
+	template <typename T>
+	Task<T> TaskPromise<T>::get_return_object() noexcept
+	{
+		return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+	}
+
+	inline Task<void> TaskPromise<void>::get_return_object() noexcept
+	{
+		return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Cambio de hilo
+// ----------------------------------------------------------------------------
+
+struct ThreadPoolAwaiter
+{
+	ThreadPool& pool;
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) { pool.submit([handle] { handle.resume(); }); }
+	void await_resume() const noexcept {}
+};
+
+// UploadQueue::push espera si la cola esta llena: solo se usa desde hilos de trabajo,
+// nunca desde el hilo GL que la vacia
+struct UploadQueueAwaiter
+{
+	UploadQueue& uploads;
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) { uploads.push([handle] { handle.resume(); }); }
+	void await_resume() const noexcept {}
+};
+
+inline ThreadPoolAwaiter resumeOn(ThreadPool& pool) { return ThreadPoolAwaiter{ pool }; }
+inline UploadQueueAwaiter resumeOn(UploadQueue& uploads) { return UploadQueueAwaiter{ uploads }; }
+
+// ----------------------------------------------------------------------------
+// whenAll
+// ----------------------------------------------------------------------------
+
+// Arranca las tareas una tras otra en el hilo actual (cada una corre hasta su primer
+// cambio de hilo) y reanuda a quien espera en el hilo de la ultima que termine
+template <typename T>
+class WhenAllAwaiter
+{
+public:
+	explicit WhenAllAwaiter(std::vector<Task<T>>& tasks) : tasks(tasks), remaining((int)tasks.size() + 1) {}
+
+	bool await_ready() const noexcept { return tasks.empty(); }
+
+	bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		for (Task<T>& task : tasks) {
+			task.handle.promise().continuation = awaiting;
+			task.handle.promise().whenAllCounter = &remaining;
+		}
+		for (Task<T>& task : tasks)
+			task.handle.resume();
+		// el +1 es de este hilo: si todas terminaron sin suspenderse se sigue sin esperar
+		return remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+	}
+
+	void await_resume() const noexcept {}
+
+private:
+	std::vector<Task<T>>& tasks;
+	std::atomic<int> remaining;
+};
+
+template <typename T>
+Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks)
+{
+	co_await WhenAllAwaiter<T>(tasks);
+	std::vector<T> results;
+	results.reserve(tasks.size());
+	for (Task<T>& task : tasks)
+		results.push_back(task.result());
+	co_return results;
+}
+
+inline Task<void> whenAll(std::vector<Task<void>> tasks)
+{
+	co_await WhenAllAwaiter<void>(tasks);
+}
+
+namespace detail
+{
+	// Para tareas de tipos distintos: se esperan todas como Task<void> y cada una deja
+	// su resultado en la tupla
+	template <typename T>
+	Task<void> storeResult(Task<T> task, std::optional<T>& slot)
+	{
+		slot.emplace(co_await std::move(task));
+	}
+}
+
+template <typename... T>
+Task<std::tuple<T...>> whenAll(Task<T>... tasks)
+{
+	std::tuple<std::optional<T>...> slots;
+	std::vector<Task<void>> stores;
+	stores.reserve(sizeof...(T));
+	std::apply([&](std::optional<T>&... slot) {
+		(stores.push_back(detail::storeResult(std::move(tasks), slot)), ...);
+	}, slots);
+	co_await WhenAllAwaiter<void>(stores);
+	co_return std::apply([](std::optional<T>&... slot) { return std::tuple<T...>(std::move(*slot)...); }, slots);
+}
+
+#endif
@@ -0,0 +1,433 @@
+#ifndef TEXTURECOOKER_H
+#define TEXTURECOOKER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <assetpack.h>
+#include <blockcompression.h>
+#include <mappedfile.h>
+#include <mipgen.h>
+
+// ============================================================================
+// TEXTURAS COCINADAS
+// Cada imagen fuente se comprime una vez por bloques (BC1/BC3/BC4/BC5) con su
+// cadena completa de mips y se guarda junto al archivo original como un DDS.
+// En los arranques siguientes se proyecta el DDS en memoria y se sube tal cual
+// con glCompressedTexImage2D: sin decodificar JPEG/PNG y con 4-8x menos VRAM.
+// ============================================================================
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT       0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+#define COOKED_TEXTURE_EXTENSION ".cooked.dds"
+#define COOKED_TEXTURE_TAG       0x5854484Du // "MHTX" en dwReserved1[0]
+#define COOKED_TEXTURE_VERSION   3u // 3: mapas de datos y de un canal sin conversion sRGB en los mips
+
+// BC5 guarda solo X e Y del mapa de normales; el shader tiene que reconstruir
+// z = sqrt(1 - x*x - y*y). Mientras los shaders lean normal.rgb directamente,
+// los mapas de normales se cocinan como BC1.
+#define COOK_NORMAL_MAPS_AS_BC5 0
+
+// Hash de la fuente con el que se valida un artefacto cocinado. Con COOKED_ASSETS_ONLY y
+// el artefacto en el pack no se toca la fuente (puede ni estar instalada); si no, se
+// hashea la fuente y solo si falta se usa el hash que registro el pack.
+inline uint64_t cookedSourceHash(const std::string& sourcePath, const std::string& cookedPath)
+{
+	uint64_t packedHash = AssetPack::instance().sourceHash(cookedPath);
+	if (COOKED_ASSETS_ONLY && packedHash != 0) return packedHash;
+	uint64_t sourceHash = hashFile(sourcePath);
+	return sourceHash != 0 ? sourceHash : packedHash;
+}
+
+enum TextureRole {
+	TEXTURE_ROLE_COLOR,  // sRGB
+	TEXTURE_ROLE_NORMAL,
+	TEXTURE_ROLE_DATA    // valores lineales: especular, altura
+};
+
+inline TextureRole textureRoleForType(const std::string& type)
+{
+	if (type == "texture_normal") return TEXTURE_ROLE_NORMAL;
+	if (type == "texture_specular" || type == "texture_height") return TEXTURE_ROLE_DATA;
+	return TEXTURE_ROLE_COLOR;
+}
+
+#define DDS_MAGIC              0x20534444u // "DDS "
+#define DDSD_CAPS              0x1
+#define DDSD_HEIGHT            0x2
+#define DDSD_WIDTH             0x4
+#define DDSD_PIXELFORMAT       0x1000
+#define DDSD_MIPMAPCOUNT       0x20000
+#define DDSD_LINEARSIZE        0x80000
+#define DDPF_FOURCC            0x4
+#define DDSCAPS_COMPLEX        0x8
+#define DDSCAPS_TEXTURE        0x1000
+#define DDSCAPS_MIPMAP         0x400000
+
+#define DDS_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+struct DDSPixelFormat {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t rgbBitCount;
+	uint32_t rBitMask, gBitMask, bBitMask, aBitMask;
+};
+
+struct DDSHeader {
+	uint32_t       size;
+	uint32_t       flags;
+	uint32_t       height;
+	uint32_t       width;
+	uint32_t       pitchOrLinearSize;
+	uint32_t       depth;
+	uint32_t       mipMapCount;
+	// [0] = COOKED_TEXTURE_TAG, [1] = version, [2..3] = hash de la fuente, [4] = canales originales
+	uint32_t       reserved1[11];
+	DDSPixelFormat pixelFormat;
+	uint32_t       caps, caps2, caps3, caps4;
+	uint32_t       reserved2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDSHeader debe medir 124 bytes");
+
+inline uint32_t fourCCForFormat(BlockFormat format)
+{
+	switch (format) {
+	case BLOCK_FORMAT_BC1: return DDS_FOURCC('D', 'X', 'T', '1');
+	case BLOCK_FORMAT_BC3: return DDS_FOURCC('D', 'X', 'T', '5');
+	case BLOCK_FORMAT_BC4: return DDS_FOURCC('A', 'T', 'I', '1');
+	case BLOCK_FORMAT_BC5: return DDS_FOURCC('A', 'T', 'I', '2');
+	}
+	return 0;
+}
+
+inline bool formatForFourCC(uint32_t fourCC, BlockFormat& format)
+{
+	const BlockFormat formats[] = { BLOCK_FORMAT_BC1, BLOCK_FORMAT_BC3, BLOCK_FORMAT_BC4, BLOCK_FORMAT_BC5 };
+	for (BlockFormat candidate : formats) {
+		if (fourCCForFormat(candidate) == fourCC) {
+			format = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+// srgb: el hardware convierte a lineal al muestrear (TextureFromFile con gamma = true)
+inline GLenum glFormatForBlockFormat(BlockFormat format, bool srgb = false)
+{
+	switch (format) {
+	case BLOCK_FORMAT_BC1: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BLOCK_FORMAT_BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case BLOCK_FORMAT_BC4: return GL_COMPRESSED_RED_RGTC1;
+	case BLOCK_FORMAT_BC5: return GL_COMPRESSED_RG_RGTC2;
+	}
+	return 0;
+}
+
+struct CompressedLevel {
+	int    width;
+	int    height;
+	size_t offset;
+	size_t size;
+};
+
+// Textura comprimida lista para subir. Los datos viven en storage (recien cocinada)
+// o en la proyeccion del DDS (cache).
+struct CompressedImage {
+	BlockFormat                  format = BLOCK_FORMAT_BC1;
+	int                          width = 0;
+	int                          height = 0;
+	std::vector<CompressedLevel> levels;     // vacio si no se pudo cargar
+	std::vector<unsigned char>   storage;
+	std::shared_ptr<MappedFile>  backing;
+	size_t                       dataOffset = 0;
+
+	bool valid() const { return !levels.empty(); }
+	const unsigned char* bytes() const { return backing ? backing->data() + dataOffset : storage.data(); }
+};
+
+// Nombre con el que se identifica una textura segun su uso (un mismo archivo puede
+// cocinarse distinto como color y como mapa de normales)
+inline std::string textureRoleKey(const std::string& path, TextureRole role)
+{
+	switch (role) {
+	case TEXTURE_ROLE_NORMAL: return path + "#normal";
+	case TEXTURE_ROLE_DATA:   return path + "#data";
+	default:                  return path;
+	}
+}
+
+inline std::string cookedTexturePath(const std::string& sourcePath, TextureRole role)
+{
+	switch (role) {
+	case TEXTURE_ROLE_NORMAL: return sourcePath + ".normal" + COOKED_TEXTURE_EXTENSION;
+	case TEXTURE_ROLE_DATA:   return sourcePath + ".data" + COOKED_TEXTURE_EXTENSION;
+	default:                  return sourcePath + COOKED_TEXTURE_EXTENSION;
+	}
+}
+
+// Los mapas de un canal (BC4) son datos aunque se usen como color
+inline MipFilter mipFilterFor(TextureRole role, BlockFormat format)
+{
+	if (role == TEXTURE_ROLE_NORMAL) return MIP_FILTER_NORMAL;
+	if (role == TEXTURE_ROLE_DATA || format == BLOCK_FORMAT_BC4) return MIP_FILTER_LINEAR;
+	return MIP_FILTER_SRGB;
+}
+
+inline BlockFormat chooseBlockFormat(TextureRole role, int components, bool hasAlpha)
+{
+	if (role == TEXTURE_ROLE_NORMAL && COOK_NORMAL_MAPS_AS_BC5) return BLOCK_FORMAT_BC5;
+	if (components == 1) return BLOCK_FORMAT_BC4; // se mantiene como GL_RED
+	return hasAlpha ? BLOCK_FORMAT_BC3 : BLOCK_FORMAT_BC1;
+}
+
+inline bool parseCookedTexture(const std::shared_ptr<MappedFile>& file, uint64_t sourceHash, CompressedImage& image)
+{
+	if (file->getSize() < 4 + sizeof(DDSHeader)) return false;
+
+	uint32_t magic;
+	std::memcpy(&magic, file->data(), 4);
+	const DDSHeader* header = (const DDSHeader*)(file->data() + 4);
+	if (magic != DDS_MAGIC || header->size != sizeof(DDSHeader)) return false;
+	if (header->reserved1[0] != COOKED_TEXTURE_TAG || header->reserved1[1] != COOKED_TEXTURE_VERSION) return false;
+	uint64_t storedHash = (uint64_t)header->reserved1[2] | ((uint64_t)header->reserved1[3] << 32);
+	if (storedHash != sourceHash) return false;
+
+	BlockFormat format;
+	if (!formatForFourCC(header->pixelFormat.fourCC, format)) return false;
+
+	CompressedImage result;
+	result.format = format;
+	result.width = (int)header->width;
+	result.height = (int)header->height;
+	result.dataOffset = 4 + sizeof(DDSHeader);
+
+	size_t offset = 0;
+	int width = result.width, height = result.height;
+	for (uint32_t level = 0; level < std::max(header->mipMapCount, 1u); level++) {
+		CompressedLevel mip;
+		mip.width = width;
+		mip.height = height;
+		mip.offset = offset;
+		mip.size = compressedSize(format, width, height);
+		offset += mip.size;
+		result.levels.push_back(mip);
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+	if (result.dataOffset + offset > file->getSize()) return false;
+
+	result.backing = file;
+	image = std::move(result);
+	return true;
+}
+
+// Primero la copia del pack montado; si quedo vieja respecto a la fuente, la suelta en disco
+inline bool readCookedTexture(const std::string& cookedPath, uint64_t sourceHash, CompressedImage& image)
+{
+	std::shared_ptr<MappedFile> packed = AssetPack::instance().open(cookedPath);
+	if (packed && parseCookedTexture(packed, sourceHash, image)) return true;
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	return file->open(cookedPath) && parseCookedTexture(file, sourceHash, image);
+}
+
+inline bool writeCookedTexture(const std::string& cookedPath, uint64_t sourceHash, int components, const CompressedImage& image)
+{
+	DDSHeader header = {};
+	header.size = sizeof(DDSHeader);
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+	header.height = (uint32_t)image.height;
+	header.width = (uint32_t)image.width;
+	header.pitchOrLinearSize = (uint32_t)image.levels[0].size;
+	header.mipMapCount = (uint32_t)image.levels.size();
+	header.reserved1[0] = COOKED_TEXTURE_TAG;
+	header.reserved1[1] = COOKED_TEXTURE_VERSION;
+	header.reserved1[2] = (uint32_t)(sourceHash & 0xFFFFFFFFu);
+	header.reserved1[3] = (uint32_t)(sourceHash >> 32);
+	header.reserved1[4] = (uint32_t)components;
+	header.pixelFormat.size = sizeof(DDSPixelFormat);
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.pixelFormat.fourCC = fourCCForFormat(image.format);
+	header.caps = DDSCAPS_TEXTURE | DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+
+	// se escribe a un temporal y se renombra para no dejar archivos a medias
+	std::string tmpPath = uniqueTempPath(cookedPath);
+	bool written;
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+		uint32_t magic = DDS_MAGIC;
+		out.write((const char*)&magic, 4);
+		out.write((const char*)&header, sizeof(header));
+		out.write((const char*)image.bytes(), image.storage.size());
+		written = (bool)out;
+	}
+	if (written) {
+		std::remove(cookedPath.c_str());
+		written = std::rename(tmpPath.c_str(), cookedPath.c_str()) == 0;
+	}
+	if (!written) std::remove(tmpPath.c_str());
+	return written;
+}
+
+// Comprime RGBA8 con toda su cadena de mips. El nivel 0 se comprime tal cual; los
+// demas salen de la imagen en float filtrada segun el uso (ver mipgen.h).
+inline void compressWithMips(const unsigned char* rgba, int width, int height, BlockFormat format, TextureRole role, CompressedImage& image)
+{
+	image.format = format;
+	image.width = width;
+	image.height = height;
+	image.levels.clear();
+	image.storage.clear();
+
+	MipFilter filter = mipFilterFor(role, format);
+	MipImage current, next;
+	std::vector<unsigned char> encoded;
+	const unsigned char* levelPixels = rgba;
+	for (;;) {
+		CompressedLevel level;
+		level.width = width;
+		level.height = height;
+		level.offset = image.storage.size();
+		level.size = compressedSize(format, width, height);
+		image.storage.resize(level.offset + level.size);
+		compressImage(levelPixels, width, height, format, image.storage.data() + level.offset);
+		image.levels.push_back(level);
+
+		if (width == 1 && height == 1) break;
+		if (current.pixels.empty())
+			decodeMipImage(rgba, width, height, filter, current);
+		downsampleMip(current, filter, next);
+		current.pixels.swap(next.pixels);
+		current.width = width = next.width;
+		current.height = height = next.height;
+		encodeMipImage(current, filter, encoded);
+		levelPixels = encoded.data();
+	}
+}
+
+// Decodifica la fuente y la comprime con sus mips, sin escribir nada (CPU; seguro en hilos de trabajo)
+inline bool compressTextureFile(const std::string& filename, TextureRole role, CompressedImage& image, int& components)
+{
+	int width, height;
+	unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &components, 4);
+	if (!pixels) return false;
+
+	bool hasAlpha = false;
+	if (components == 2 || components == 4) {
+		for (size_t i = 0; i < (size_t)width * height && !hasAlpha; i++)
+			hasAlpha = pixels[i * 4 + 3] != 255;
+	}
+
+	compressWithMips(pixels, width, height, chooseBlockFormat(role, components, hasAlpha), role, image);
+	stbi_image_free(pixels);
+	return true;
+}
+
+// Carga la version cocinada de una textura o la genera (CPU; seguro en hilos de trabajo).
+// sourceHash es el de cookedSourceHash(), ya calculado por quien llama (0: no hay fuente).
+inline bool loadCookedTexture(const std::string& filename, TextureRole role, uint64_t sourceHash, CompressedImage& image)
+{
+	std::string cookedPath = cookedTexturePath(filename, role);
+	if (sourceHash == 0) return false;
+	if (readCookedTexture(cookedPath, sourceHash, image))
+		return true;
+#if COOKED_ASSETS_ONLY
+	std::cout << "ERROR::TEXTURE_COOKER:: missing or stale cooked texture " << cookedPath << std::endl;
+	return false;
+#else
+	int components;
+	if (!compressTextureFile(filename, role, image, components)) return false;
+
+	if (!writeCookedTexture(cookedPath, sourceHash, components, image))
+		std::cout << "WARNING::TEXTURE_COOKER:: could not write " << cookedPath << std::endl;
+	return true;
+#endif
+}
+
+inline bool loadCookedTexture(const std::string& filename, TextureRole role, CompressedImage& image)
+{
+	return loadCookedTexture(filename, role, cookedSourceHash(filename, cookedTexturePath(filename, role)), image);
+}
+
+// Sube los niveles desde firstLevel de una imagen comprimida al target indicado (solo hilo GL)
+inline void uploadCompressedLevels(GLenum target, const CompressedImage& image, bool srgb = false, size_t firstLevel = 0)
+{
+	GLenum format = glFormatForBlockFormat(image.format, srgb);
+	const unsigned char* bytes = image.bytes();
+	for (size_t level = firstLevel; level < image.levels.size(); level++) {
+		const CompressedLevel& mip = image.levels[level];
+		glCompressedTexImage2D(target, (GLint)level, format, mip.width, mip.height, 0, (GLsizei)mip.size, bytes + mip.offset);
+	}
+}
+
+// Primer nivel que entra en maxSize x maxSize: con streaming la textura se crea desde
+// ahi y los niveles mas grandes llegan despues con uploadCompressedMip()
+inline size_t streamingBaseLevel(const CompressedImage& image, int maxSize)
+{
+	size_t level = 0;
+	while (level + 1 < image.levels.size() &&
+		(image.levels[level].width > maxSize || image.levels[level].height > maxSize))
+		level++;
+	return level;
+}
+
+// Crea la textura GL 2D a partir de la imagen cocinada (solo hilo GL)
+// Los mips ya vienen cocinados: nunca se llama a glGenerateMipmap.
+// firstLevel > 0 sube solo los mips chicos y deja GL_TEXTURE_BASE_LEVEL en ese nivel.
+inline unsigned int uploadCompressedTexture(const CompressedImage& image, bool srgb = false, size_t firstLevel = 0)
+{
+	unsigned int textureID;
+	glGenTextures(1, &textureID);
+
+	if (image.valid())
+	{
+		firstLevel = std::min(firstLevel, image.levels.size() - 1);
+		glBindTexture(GL_TEXTURE_2D, textureID);
+		uploadCompressedLevels(GL_TEXTURE_2D, image, srgb, firstLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)firstLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+
+	return textureID;
+}
+
+// Agrega a una textura creada con firstLevel el nivel inmediatamente mas grande y lo
+// deja como base: la textura se ve mas nitida sin cambiar de id (solo hilo GL)
+inline void uploadCompressedMip(unsigned int textureID, const CompressedImage& image, size_t level, bool srgb = false)
+{
+	const CompressedLevel& mip = image.levels[level];
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, glFormatForBlockFormat(image.format, srgb),
+		mip.width, mip.height, 0, (GLsizei)mip.size, image.bytes() + mip.offset);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)level);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+#endif
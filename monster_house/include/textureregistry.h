@@ -0,0 +1,256 @@
+#ifndef TEXTUREREGISTRY_H
+#define TEXTUREREGISTRY_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <iostream>
+#include <mappedfile.h>
+#include <texturecooker.h>
+#include <textureresource.h>
+
+// Identidad de una textura: ruta absoluta canonica con su uso. Armarla no lee el
+// archivo; el hash de la fuente (TextureRegistry::sourceHash) solo se calcula cuando
+// la ruta no esta cargada y hay que validar o cargar el artefacto cocinado.
+struct TextureKey
+{
+	std::string path;
+	TextureRole role = TEXTURE_ROLE_COLOR;
+
+	// Hash con el que se comparten texturas de igual contenido: un mismo archivo
+	// cocinado como mapa de normales es otra textura de GPU
+	uint64_t contentHash(uint64_t sourceHash) const
+	{
+		if (sourceHash == 0 || role == TEXTURE_ROLE_COLOR) return sourceHash;
+		return hashBytes((const unsigned char*)&role, sizeof(role), sourceHash);
+	}
+};
+
+// Registro de texturas de todo el proceso. Reemplaza a los textures_loaded de cada
+// modelo: la misma imagen usada por dos FBX distintos (o copiada con otro nombre)
+// se decodifica y se sube una sola vez: cada ruta tiene su propio TextureResource y
+// las de igual contenido comparten el objeto de GL. Guarda weak_ptr, asi que no alarga
+// la vida de las texturas; las entradas vencidas se limpian al volver a buscarlas.
+class TextureRegistry
+{
+public:
+	static TextureRegistry& instance()
+	{
+		static TextureRegistry registry;
+		return registry;
+	}
+
+	TextureRegistry(const TextureRegistry&) = delete;
+	TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+	static std::string canonicalPath(const std::string& path)
+	{
+		std::string result = path;
+#ifdef _WIN32
+		char buffer[_MAX_PATH];
+		if (_fullpath(buffer, path.c_str(), _MAX_PATH))
+			result = buffer;
+		// NTFS no distingue mayusculas
+		for (char& c : result) {
+			if (c == '\\') c = '/';
+			else if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+		}
+#else
+		char* resolved = realpath(path.c_str(), nullptr);
+		if (resolved) {
+			result = resolved;
+			free(resolved);
+		}
+#endif
+		return result;
+	}
+
+	static TextureKey makeKey(const std::string& filename, TextureRole role = TEXTURE_ROLE_COLOR)
+	{
+		TextureKey key;
+		key.path = textureRoleKey(canonicalPath(filename), role);
+		key.role = role;
+		return key;
+	}
+
+	// Hash de la fuente para validar su artefacto cocinado. Lee el archivo (salvo con
+	// COOKED_ASSETS_ONLY y la textura en el pack), asi que es para hilos de trabajo y
+	// solo despues de que acquire() no la encontro.
+	static uint64_t sourceHash(const std::string& filename, TextureRole role)
+	{
+		return cookedSourceHash(filename, cookedTexturePath(filename, role));
+	}
+
+	// Busca una textura viva por ruta (un hit es una busqueda en un mapa); devuelve
+	// nullptr si hay que cargarla. Thread-safe.
+	TextureHandle acquire(const TextureKey& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return findLocked(key);
+	}
+
+	// Despues de un acquire() fallido y con el hash ya calculado: si otra ruta tiene el
+	// mismo contenido cargado, esta ruta lo comparte sin decodificar nada. Thread-safe.
+	TextureHandle acquireContent(const TextureKey& key, uint64_t sourceHash)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		TextureHandle handle = findLocked(key);
+		return handle ? handle : findContentLocked(key, key.contentHash(sourceHash));
+	}
+
+	// Carga en curso de una ruta desde los hilos de trabajo. El primero que la pide
+	// (tras un acquire() fallido) recibe true: la carga, encola su subida y llama a
+	// endLoad(). Los demas esperan aqui hasta ese endLoad() y reciben false; como la
+	// cola de subidas es FIFO, lo que encolen despues corre en el hilo GL con la textura
+	// ya registrada. No se llama desde el hilo GL, que es el que vacia esa cola.
+	bool beginLoad(const TextureKey& key)
+	{
+		std::shared_future<void> done;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = loading.find(key.path);
+			if (it == loading.end()) {
+				loading[key.path];
+				return true;
+			}
+			done = it->second.done;
+		}
+		done.wait();
+		return false;
+	}
+
+	void endLoad(const TextureKey& key)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = loading.find(key.path);
+		if (it == loading.end()) return;
+		it->second.promise.set_value();
+		loading.erase(it);
+	}
+
+	// Registra una textura recien subida (solo hilo GL). Si otro hilo ya registro
+	// la ruta o el mismo contenido mientras se decodificaba, se descarta la copia nueva.
+	TextureHandle insert(const TextureKey& key, uint64_t sourceHash, unsigned int id)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		uint64_t hash = key.contentHash(sourceHash);
+		TextureHandle existing = findLocked(key);
+		if (!existing) existing = findContentLocked(key, hash);
+		if (existing) {
+			glDeleteTextures(1, &id);
+			return existing;
+		}
+
+		GLTextureRef object = std::make_shared<GLTextureObject>(id);
+		TextureHandle handle = std::make_shared<TextureResource>(object, key.path);
+		byPath[key.path] = Entry{ handle, hash };
+		if (hash != 0)
+			byHash[hash] = object;
+		return handle;
+	}
+
+	// Carga sincrona desde disco, usando la version cocinada (solo hilo GL). Si la ruta
+	// ya esta cargada no toca el archivo.
+	TextureHandle load(const std::string& filename, TextureRole role = TEXTURE_ROLE_COLOR)
+	{
+		TextureKey key = makeKey(filename, role);
+		TextureHandle handle = acquire(key);
+		if (handle) return handle;
+
+		uint64_t hash = sourceHash(filename, role);
+		handle = acquireContent(key, hash);
+		if (handle) return handle;
+
+		CompressedImage image;
+		if (!loadCookedTexture(filename, role, hash, image))
+			std::cout << "Texture failed to load at path: " << filename << std::endl;
+		return insert(key, hash, uploadCompressedTexture(image));
+	}
+
+	// true si hay una textura viva registrada con esa ruta (cualquier contenido). Thread-safe.
+	bool isLoaded(const std::string& path)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = byPath.find(path);
+		return it != byPath.end() && !it->second.texture.expired();
+	}
+
+	// Recarga en caliente (solo hilo GL): la textura viva con key.path pasa a usar el
+	// nuevo objeto de GL; sus handles lo ven sin tocar los meshes. Las otras rutas que
+	// compartian el objeto anterior (mismo contenido) lo conservan.
+	bool replace(const TextureKey& key, uint64_t sourceHash, unsigned int id)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = byPath.find(key.path);
+		TextureHandle handle = it != byPath.end() ? it->second.texture.lock() : nullptr;
+		if (!handle) {
+			glDeleteTextures(1, &id);
+			return false;
+		}
+
+		GLTextureRef object = std::make_shared<GLTextureObject>(id);
+		uint64_t hash = key.contentHash(sourceHash);
+		handle->retarget(object);
+		it->second.hash = hash;
+		if (hash != 0)
+			byHash[hash] = object;
+		return true;
+	}
+
+private:
+	struct Entry
+	{
+		std::weak_ptr<TextureResource> texture;
+		uint64_t hash;
+	};
+
+	std::unordered_map<std::string, Entry> byPath;
+	struct Loading
+	{
+		std::promise<void>       promise;
+		std::shared_future<void> done = promise.get_future().share();
+	};
+
+	std::unordered_map<uint64_t, std::weak_ptr<GLTextureObject>> byHash;
+	std::unordered_map<std::string, Loading> loading; // por ruta, mientras un hilo la carga
+	std::mutex mutex;
+
+	TextureRegistry() {}
+
+	// Los cambios del archivo de una ruta ya cargada los aplica replace() (recarga en caliente)
+	TextureHandle findLocked(const TextureKey& key)
+	{
+		auto pathIt = byPath.find(key.path);
+		if (pathIt == byPath.end()) return nullptr;
+		TextureHandle handle = pathIt->second.texture.lock();
+		if (!handle) byPath.erase(pathIt);
+		return handle;
+	}
+
+	TextureHandle findContentLocked(const TextureKey& key, uint64_t hash)
+	{
+		if (hash != 0) {
+			auto hashIt = byHash.find(hash);
+			if (hashIt != byHash.end()) {
+				GLTextureRef object = hashIt->second.lock();
+				if (object) {
+					// mismo contenido con otro nombre: recurso propio sobre el mismo objeto de GL
+					TextureHandle handle = std::make_shared<TextureResource>(object, key.path);
+					byPath[key.path] = Entry{ handle, hash };
+					return handle;
+				}
+				byHash.erase(hashIt);
+			}
+		}
+		return nullptr;
+	}
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TEXTURERESOURCE_H
+#define TEXTURERESOURCE_H
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <string>
+
+// Objeto de textura de OpenGL. Lo comparten todas las rutas con el mismo contenido y
+// se borra de la GPU al soltar la ultima referencia, por eso las referencias (y los
+// handles que las tienen) solo deben liberarse en el hilo del contexto GL.
+struct GLTextureObject
+{
+	unsigned int id;
+
+	explicit GLTextureObject(unsigned int id) : id(id) {}
+	~GLTextureObject() { glDeleteTextures(1, &id); }
+
+	GLTextureObject(const GLTextureObject&) = delete;
+	GLTextureObject& operator=(const GLTextureObject&) = delete;
+};
+
+typedef std::shared_ptr<GLTextureObject> GLTextureRef;
+
+// Textura de una ruta. Dos rutas con el mismo contenido tienen cada una su recurso
+// apuntando al mismo objeto de GL, asi que recargar una (TextureRegistry::replace)
+// no cambia la otra. El id puede cambiar en esa recarga, por eso quien dibuja lo
+// lee del handle en cada bind.
+struct TextureResource
+{
+	unsigned int id;
+	std::string key;
+	GLTextureRef object;
+
+	TextureResource(const GLTextureRef& object, const std::string& key) : id(object->id), key(key), object(object) {}
+
+	void retarget(const GLTextureRef& newObject)
+	{
+		object = newObject;
+		id = newObject->id;
+	}
+
+	TextureResource(const TextureResource&) = delete;
+	TextureResource& operator=(const TextureResource&) = delete;
+};
+
+typedef std::shared_ptr<TextureResource> TextureHandle;
+
+#endif
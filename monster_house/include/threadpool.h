@@ -0,0 +1,81 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Pool fijo de hilos de trabajo para tareas de CPU (parseo, decodificacion de imagenes...).
+// Las tareas nunca deben tocar OpenGL: el contexto solo es valido en el hilo principal.
+class ThreadPool
+{
+public:
+	explicit ThreadPool(unsigned int numThreads = 0)
+	{
+		if (numThreads == 0) {
+			unsigned int hw = std::thread::hardware_concurrency();
+			numThreads = hw > 1 ? hw - 1 : 1;
+		}
+		for (unsigned int i = 0; i < numThreads; i++)
+			workers.emplace_back([this] { workerLoop(); });
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		condition.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	template <typename F>
+	auto submit(F&& task) -> std::future<decltype(task())>
+	{
+		typedef decltype(task()) Result;
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		std::future<Result> result = packaged->get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push([packaged] { (*packaged)(); });
+		}
+		condition.notify_one();
+		return result;
+	}
+
+	unsigned int size() const { return (unsigned int)workers.size(); }
+
+private:
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping = false;
+
+	void workerLoop()
+	{
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+				if (stopping && tasks.empty()) return;
+				task = std::move(tasks.front());
+				tasks.pop();
+			}
+			task();
+		}
+	}
+};
+
+#endif
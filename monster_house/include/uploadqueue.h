@@ -0,0 +1,65 @@
+#ifndef UPLOADQUEUE_H
+#define UPLOADQUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Cola acotada de trabajos de OpenGL. Los hilos de trabajo encolan la creacion de
+// buffers/texturas y el hilo principal la vacia con un presupuesto de tiempo por frame.
+// Si la cola se llena, el productor espera: asi la memoria decodificada pendiente de
+// subir queda limitada aunque los hilos de trabajo vayan mas rapido que la GPU.
+class UploadQueue
+{
+public:
+	explicit UploadQueue(size_t capacity = 64) : capacity(capacity) {}
+
+	// Llamado desde cualquier hilo
+	void push(std::function<void()> task)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this] { return tasks.size() < capacity; });
+		tasks.push_back(std::move(task));
+	}
+
+	// Solo en el hilo del contexto GL. Ejecuta al menos un trabajo y sigue mientras
+	// quede tiempo del presupuesto. Devuelve cuantos trabajos se ejecutaron.
+	int drain(double budgetSeconds)
+	{
+		auto start = std::chrono::steady_clock::now();
+		int executed = 0;
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (tasks.empty()) break;
+				task = std::move(tasks.front());
+				tasks.pop_front();
+			}
+			notFull.notify_one();
+
+			task();
+			executed++;
+
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			if (elapsed.count() >= budgetSeconds) break;
+		}
+		return executed;
+	}
+
+	bool empty()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return tasks.empty();
+	}
+
+private:
+	size_t capacity;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable notFull;
+};
+
+#endif
@@ -33,10 +33,14 @@
 #include "PhysicsSystem.h"
 #include "RenderableObject.h"
 #include "AnimatedRenderableObject.h"
+#include "AnimatedCrowd.h"
 #include "OrbitingMoonObject.h"
 #include "AxisGizmo.h"
 #include "LightIndicator.h"
 #include "LoadingScreen.h"
+#include "AssetLoader.h"
+#include "AssetStreamer.h"
+#include "AssetHotReload.h"
 #include "InputController.h"
 #include "SceneManager.h"
 #include "HierarchicalObject.h"
@@ -70,6 +74,7 @@ glm::vec3 position(5.0f, 7.0f, -70.0f);
 glm::vec3 forwardView(0.0f, 0.0f, 1.0f);
 float rotateCharacter = 0.0f;
 bool isPlayerMoving = false;
+float playerLocomotionSpeed = 0.0f; // 0 quieto, 1 caminando, runMultiplier corriendo
 
 // Estado de la cámara
 float trdpersonOffset = 5.0f;
@@ -78,8 +83,11 @@ bool showLightIndicators = true;
 
 // Sistemas principales
 PhysicsSystem physicsSystem;
+std::unique_ptr<AnimationGraph> astronautLocomotion; // compartido por los astronautas del jugador
 std::unique_ptr<SceneManager> sceneManager;
 std::unique_ptr<InputController> inputController;
+std::unique_ptr<AssetStreamer> assetStreamer;
+std::unique_ptr<AssetHotReload> hotReload;
 
 // ============================================================================
 // CALLBACKS DE GLFW
@@ -160,53 +168,38 @@ void loadShaders(LoadingScreen& loadingScreen,
 		"monster_house/shaders/moon_orbit_phong.fs");
 }
 
-void loadModels(LoadingScreen& loadingScreen,
-	AnimatedModel*& animatedAstronauta, Model*& house, Model*& sol,
-	Model*& piso, Model*& naveEspacial, Model*& satelite,
-	Model*& panelSolar, Model*& invernadero, Model*& escalera,
-	Model*& puerta, Model*& cama, Model*& satelite2, Model*& comedor,
-	Model*& sofa, Model*& leafB, Model*& prime1, Model*& domoInvernadero,
-	Model*& domoEstructura, Model*& tunelMetal, Model*& plantas) {
+// Recursos de la escena; los modelos que fueron eliminados de la carga quedan en nullptr
+struct SceneAssets {
+	AnimatedModel* animatedAstronauta = nullptr;
+	Model* house = nullptr, * sol = nullptr, * piso = nullptr, * naveEspacial = nullptr, * satelite = nullptr;
+	Model* panelSolar = nullptr, * invernadero = nullptr, * escalera = nullptr, * puerta = nullptr, * cama = nullptr;
+	Model* satelite2 = nullptr, * comedor = nullptr, * sofa = nullptr, * leafB = nullptr, * prime1 = nullptr;
+	Model* domoInvernadero = nullptr, * domoEstructura = nullptr, * tunelMetal = nullptr, * plantas = nullptr;
+	CubeMap* skybox = nullptr;
+};
+
+// Anuncia un recurso en la pantalla de carga cuando termina de subirse (en el hilo GL),
+// no cuando se pide: los pedidos salen todos juntos
+template <typename T>
+Task<T> announceWhenLoaded(LoadingScreen& loadingScreen, Task<T> load, std::string message) {
+	T result = co_await std::move(load);
+	loadingScreen.updateProgress(message);
+	co_return result;
+}
+
+Task<SceneAssets> loadSceneAssets(LoadingScreen& loadingScreen, AssetLoader& loader) {
 
 	// ============================================================================
-	// CARGA SECUENCIAL OPTIMIZADA CON FEEDBACK DETALLADO
+	// CARGA EN SEGUNDO PLANO: los modelos y el skybox se leen en hilos de trabajo a
+	// la vez; la tarea se reanuda en el hilo GL cuando todos estan subidos
 	// SOLO MANTENEMOS LA CASA Y EL PISO LUNAR
 	// ============================================================================
 
 	loadingScreen.updateProgress("Iniciando carga...");
 
-	// Entorno básico
-	loadingScreen.updateProgress("Cargando piso...");
-	piso = new Model("monster_house/models/piso.fbx");
-
-	loadingScreen.updateProgress("Cargando casa principal...");
-	house = new Model("monster_house/models/MonsterHouseFinal.fbx");
-
-	// Los modelos restantes se establecen a nullptr ya que fueron eliminados de la carga
-	animatedAstronauta = nullptr;
-	sol = nullptr;
-	naveEspacial = nullptr;
-	satelite = nullptr;
-	panelSolar = nullptr;
-	invernadero = nullptr;
-	escalera = nullptr;
-	puerta = nullptr;
-	cama = nullptr;
-	satelite2 = nullptr;
-	comedor = nullptr;
-	sofa = nullptr;
-	leafB = nullptr;
-	prime1 = nullptr;
-	domoInvernadero = nullptr;
-	domoEstructura = nullptr;
-	tunelMetal = nullptr;
-	plantas = nullptr;
-
-	loadingScreen.updateProgress("Modelos esenciales cargados exitosamente!");
-}
-
-CubeMap* loadSkybox(LoadingScreen& loadingScreen) {
-	loadingScreen.updateProgress("Cargando skybox del espacio...");
+	// la casa viene partida en cientos de meshes: se combinan en un draw call por material
+	ImportOptions mergeByMaterial;
+	mergeByMaterial.mergeStaticMeshes = true;
 
 	vector<std::string> faces{
 		"monster_house/textures/cubemap/01/px.jpg",
@@ -217,9 +210,13 @@ CubeMap* loadSkybox(LoadingScreen& loadingScreen) {
 		"monster_house/textures/cubemap/01/nz.jpg"
 	};
 
-	CubeMap* mainCubeMap = new CubeMap();
-	mainCubeMap->loadCubemap(faces);
-	return mainCubeMap;
+	SceneAssets scene;
+	std::tie(scene.piso, scene.house, scene.skybox) = co_await whenAll(
+		announceWhenLoaded(loadingScreen, loader.loadModel("monster_house/models/piso.fbx"), "Piso cargado"),
+		announceWhenLoaded(loadingScreen, loader.loadModel("monster_house/models/MonsterHouseFinal.fbx", mergeByMaterial),
+			"Casa principal cargada"),
+		announceWhenLoaded(loadingScreen, loader.loadCubemap(faces), "Skybox del espacio cargado"));
+	co_return scene;
 }
 
 void setupLighting(size_t& sunLightIdx, size_t& invernaderoLightIdx,
@@ -301,6 +298,31 @@ void defineMaterials(Material& astronautMaterial, Material& lunarFloorMaterial,
 	materialPlantas = Material();
 }
 
+// Grafo del jugador: reposo y locomocion, un blend 1D por velocidad (1 caminar,
+// runSpeed correr). Si el modelo no trae clips con esos nombres, caminar es su clip por
+// defecto, correr es el mismo clip mas rapido y el reposo lo deja quieto.
+std::unique_ptr<AnimationGraph> buildLocomotionGraph(AnimatedModel* model, float runSpeed) {
+	auto graph = std::make_unique<AnimationGraph>(model);
+	// la entrada salta entre 0, 1 y runSpeed: suavizado para que la mezcla no cambie de golpe
+	int speed = graph->addParameter("speed", 0.0f, 0.15f);
+
+	int walkClip = model->findClip("walk");
+	if (walkClip < 0) walkClip = (int)model->defaultAnimation;
+	int runClip = model->findClip("run");
+	int idleClip = model->findClip("idle");
+
+	int walk = graph->addClip(walkClip);
+	int run = runClip >= 0 ? graph->addClip(runClip) : graph->addClip(walkClip, runSpeed);
+	int idle = idleClip >= 0 ? graph->addClip(idleClip) : graph->addClip(walkClip, 0.0f);
+	int locomotion = graph->addBlend1D(speed, { { 1.0f, walk }, { runSpeed, run } });
+
+	int idleState = graph->addState("reposo", idle);
+	int moveState = graph->addState("locomocion", locomotion);
+	graph->addTransition(idleState, moveState, speed, TRANSITION_GREATER, 0.01f, 0.2f);
+	graph->addTransition(moveState, idleState, speed, TRANSITION_LESS, 0.01f, 0.3f);
+	return graph;
+}
+
 void createSceneObjects(AnimatedModel* animatedAstronauta, Shader* dynamicShader,
 	Model* piso, Model* house, Model* invernadero,
 	Model* naveEspacial, Model* satelite, Model* satelite2,
@@ -334,9 +356,18 @@ void createSceneObjects(AnimatedModel* animatedAstronauta, Shader* dynamicShader
 	houseObj->addAffectedLight(interiorCasaLightIdx);
 	sceneManager->addObject(std::move(houseObj));
 
+	// Astronauta del jugador, solo si el modelo animado se carga: el grafo mezcla reposo,
+	// caminar y correr segun la velocidad que deja el InputController
+	if (animatedAstronauta && animatedAstronauta->skeleton.getClipCount() > 0) {
+		astronautLocomotion = buildLocomotionGraph(animatedAstronauta, inputController->getRunMultiplier());
+		auto astronautObj = std::make_unique<AnimatedRenderableObject>(
+			animatedAstronauta, dynamicShader, &physicsSystem, &position, &rotateCharacter);
+		astronautObj->setMaterial(astronautMaterial);
+		astronautObj->setAnimationGraph(astronautLocomotion.get(), &playerLocomotionSpeed);
+		sceneManager->addObject(std::move(astronautObj));
+	}
 
-
-	// El resto de los objetos (astronauta, invernadero, naves, satélites, props) han sido eliminados.
+	// El resto de los objetos (invernadero, naves, satélites, props) han sido eliminados.
 	// Se dejan los punteros nulos para evitar fallos.
 	satellitePtr = nullptr;
 	satellite2Ptr = nullptr;
@@ -375,6 +406,30 @@ void generateLunarHousesExample(Model* house, Shader* mLightsShader,
 	// Se elimina la generación de casas adicionales.
 	std::cout << "\n[DEMO] Generacion de colonias lunares desactivada." << std::endl;
 }
+// Cuadricula de astronautas que comparten el modelo animado; las poses de todos se
+// evaluan juntas (AnimatedCrowd), cada uno desfasado en el clip
+void generateAstronautColony(AnimatedModel* animatedAstronauta, Shader* dynamicShader,
+	const Material& astronautMaterial) {
+	if (!animatedAstronauta || animatedAstronauta->getClipFrames(animatedAstronauta->defaultAnimation) <= 1.0) {
+		std::cout << "\n[DEMO] Colonia de astronautas desactivada (modelo animado no cargado)." << std::endl;
+		return;
+	}
+
+	const int columns = 16, rows = 16;
+	const float spacing = 3.0f;
+	auto crowd = std::make_unique<AnimatedCrowd>(animatedAstronauta, dynamicShader,
+		glm::vec3(-columns * spacing * 0.5f, 0.0f, 40.0f));
+	crowd->setMaterial(astronautMaterial);
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < columns; column++) {
+			int index = row * columns + column;
+			crowd->addInstance(glm::vec3(column * spacing, 0.0f, row * spacing),
+				(float)((index * 37) % 360), index * 7.3f);
+		}
+	}
+	std::cout << "\n[DEMO] Colonia de " << crowd->getInstanceCount() << " astronautas animados." << std::endl;
+	sceneManager->addObject(std::move(crowd));
+}
 
 void setupDebugTools(OrbitingMoonObject* satellitePtr, OrbitingMoonObject* satellite2Ptr,
 	size_t satelliteLightIndex, size_t satellite2LightIndex) {
@@ -420,26 +475,37 @@ bool Start() {
 	LoadingScreen loadingScreen(window, 24);
 	loadingScreen.render();
 
-	// Variables locales (se mantienen solo las necesarias o se inicializan a nullptr)
+	// Variables locales
 	Shader* cubemapShader, * dynamicShader, * mLightsShader, * mMoonShader;
-	AnimatedModel* animatedAstronauta = nullptr; // Eliminado
-	Model* house, * sol = nullptr, * piso, * naveEspacial = nullptr, * satelite = nullptr, * panelSolar = nullptr; // Eliminados
-	Model* invernadero = nullptr, * escalera = nullptr, * puerta = nullptr, * cama = nullptr, * satelite2 = nullptr, * comedor = nullptr; // Eliminados
-	Model* sofa = nullptr, * leafB = nullptr, * prime1 = nullptr, * domoInvernadero = nullptr, * domoEstructura = nullptr, * tunelMetal = nullptr; // Eliminados
-	Model* plantas = nullptr; // Eliminado
 
-	// Cargar recursos
+	// Cargar recursos: la tarea lanza modelos y skybox en los hilos de trabajo y
+	// vuelve enseguida, asi se procesan mientras se compilan los shaders en el hilo GL
+	// Pack de assets cocinados por asset_cooker; sin pack se leen los archivos sueltos
+	AssetPack::instance().mount("monster_house/assets" ASSET_PACK_EXTENSION);
+	// Carga progresiva: la escena arranca con los LODs simples y los mips chicos, y el
+	// detalle completo llega en segundo plano, primero lo mas cercano a la camara
+	assetStreamer = std::make_unique<AssetStreamer>();
+	AssetLoader loader(0, assetStreamer.get());
+	// Solo cargará la casa, el piso y el skybox
+	Task<SceneAssets> loading = loadSceneAssets(loadingScreen, loader);
+	loading.start();
+	loadingScreen.updateProgress("Modelos esenciales en cola de carga...");
 	loadShaders(loadingScreen, cubemapShader, dynamicShader, mLightsShader, mMoonShader);
-	// Solo cargará la casa y el piso
-	loadModels(loadingScreen, animatedAstronauta, house, sol, piso, naveEspacial,
-		satelite, panelSolar, invernadero, escalera, puerta, cama, satelite2,
-		comedor, sofa, leafB, prime1, domoInvernadero, domoEstructura, tunelMetal, plantas);
-	CubeMap* mainCubeMap = loadSkybox(loadingScreen);
+	loader.finish(loadingScreen, loading);
+	SceneAssets scene = loading.result();
+
+	// Recarga en caliente: re-exportar un FBX o editar una textura/shader se ve sin reiniciar
+	hotReload = std::make_unique<AssetHotReload>("monster_house");
+	hotReload->watchModels(loader);
+	hotReload->watchShader(cubemapShader);
+	hotReload->watchShader(dynamicShader);
+	hotReload->watchShader(mLightsShader);
+	hotReload->watchShader(mMoonShader);
 
 	// Inicializar sistemas
 	loadingScreen.updateProgress("Inicializando gestores de escena...");
 	sceneManager = std::make_unique<SceneManager>(camera, camera3rd, activeCamera);
-	sceneManager->setCubemap(mainCubeMap, cubemapShader);
+	sceneManager->setCubemap(scene.skybox, cubemapShader);
 
 	inputController = std::make_unique<InputController>(
 		position, forwardView, rotateCharacter, activeCamera,
@@ -468,16 +534,17 @@ bool Start() {
 	OrbitingMoonObject* satellite2Ptr = nullptr;
 	size_t satelliteLightIndex = 0, satellite2LightIndex = 0;
 
-	createSceneObjects(animatedAstronauta, dynamicShader, piso, house, invernadero,
-		naveEspacial, satelite, satelite2, sofa, leafB, prime1, sol, comedor,
-		plantas,
+	createSceneObjects(scene.animatedAstronauta, dynamicShader, scene.piso, scene.house,
+		scene.invernadero, scene.naveEspacial, scene.satelite, scene.satelite2, scene.sofa,
+		scene.leafB, scene.prime1, scene.sol, scene.comedor, scene.plantas,
 		mLightsShader, mMoonShader, astronautMaterial, lunarFloorMaterial,
 		houseMaterial, spaceshipMaterial, sateliteMaterial, invernaderoMaterial,
 		sofaLuna, neutroSol, comedorMaterial, materialPlantas, interiorCasaLightIdx, invernaderoLightIdx,
 		satellitePtr, satellite2Ptr, satelliteLightIndex, satellite2LightIndex);
 
 	// Creación de props eliminada
-	createProps(panelSolar, escalera, puerta, cama, domoInvernadero, domoEstructura, tunelMetal,
+	createProps(scene.panelSolar, scene.escalera, scene.puerta, scene.cama,
+		scene.domoInvernadero, scene.domoEstructura, scene.tunelMetal,
 		mLightsShader, solarPanelMaterial, escaleraMaterial, puertaMaterial, camaMaterial,
 		azulTransparente, domoEstrutura, tunelMetalMaterial, panelSolarLightIdx, interiorCasaLightIdx);
 
@@ -487,9 +554,10 @@ bool Start() {
 
 	// Generación de objetos extra eliminada
 	loadingScreen.updateProgress("Generando colonias lunares...");
-	generateLunarHousesExample(house, mLightsShader, houseMaterial);
+	generateLunarHousesExample(scene.house, mLightsShader, houseMaterial);
 	loadingScreen.updateProgress("Generando flota de naves espaciales...");
-	generateSpaceships(naveEspacial, mLightsShader, spaceshipMaterial);
+	generateSpaceships(scene.naveEspacial, mLightsShader, spaceshipMaterial);
+	generateAstronautColony(scene.animatedAstronauta, dynamicShader, astronautMaterial);
 
 	// Configurar cámaras y finalizar (SE MANTIENE)
 	setupCameras();
@@ -511,6 +579,10 @@ bool Update() {
 	lastFrame = currentFrame;
 
 	processInput(window);
+	if (assetStreamer)
+		assetStreamer->update();
+	if (hotReload)
+		hotReload->update();
 
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -571,6 +643,9 @@ int main() {
 			break;
 	}
 
+	// las recargas pendientes usan el contexto GL
+	hotReload.reset();
+	assetStreamer.reset();
 	glfwTerminate();
 	return 0;
 }
\ No newline at end of file